@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <format>
+#include <fstream>
+
+#include <ReferenceLambertW.h>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// Build flags, passed in by CMake
+#ifndef REFERENCEW_BENCH_FLAGS
+#define REFERENCEW_BENCH_FLAGS ""
+#endif
+#ifndef REFERENCEW_BENCH_CONFIG
+#define REFERENCEW_BENCH_CONFIG ""
+#endif
+
+inline std::string GetCompiler()
+{
+#if defined(__clang__)
+	return std::format("Clang {}.{}.{}", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+	return std::format("GCC {}.{}.{}", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+	return std::format("MSVC {}", _MSC_FULL_VER);
+#else
+	return "Unknown";
+#endif
+}
+
+inline std::string GetCpuModel()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	// Brand string from the extended cpuid leaves
+	int regs[12];
+	__cpuid(regs, 0x80000002);
+	__cpuid(regs + 4, 0x80000003);
+	__cpuid(regs + 8, 0x80000004);
+	std::string brand(reinterpret_cast<const char*>(regs), sizeof(regs));
+	return brand.substr(0, brand.find('\0'));
+#else
+	std::ifstream file{ "/proc/cpuinfo" };
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.starts_with("model name"))
+		{
+			size_t colon = line.find(':');
+			if (colon != std::string::npos)
+				return line.substr(line.find_first_not_of(' ', colon + 1));
+		}
+	}
+	return "Unknown";
+#endif
+}
+
+inline bool GetStatsEnabled()
+{
+	return REFERENCEW_STATS;
+}
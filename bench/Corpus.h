@@ -0,0 +1,237 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span>
+#include <fstream>
+#include <iostream>
+#include <format>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*
+Benchmark input corpus
+
+A corpus is a single little-endian file of named sections of float or double inputs, so every build
+and machine can be measured on identical inputs without paying for an RNG in the benchmark:
+	CorpusHeader
+	CorpusSection[numSections]
+	section data, each starting on a 64 byte boundary
+
+A section is identified by its distribution name, branch and [min, max) parameters, where the
+meaning of the range depends on the distribution (e.g. the uniform variable of an exp-mapped bin).
+The file is mapped read-only where mmap is available, and read into memory otherwise.
+*/
+
+struct CorpusHeader
+{
+	char magic[8]; // "RLWCORP1"
+	uint32_t version;
+	uint32_t numSections;
+};
+
+struct CorpusSection
+{
+	char name[32];
+	uint32_t elementSize; // 4 for float, 8 for double
+	int32_t branch;
+	double min, max;
+	uint64_t offset; // From the start of the file
+	uint64_t count;
+};
+
+inline constexpr char CorpusMagic[8] = { 'R', 'L', 'W', 'C', 'O', 'R', 'P', '1' };
+inline constexpr uint32_t CorpusVersion = 1;
+inline constexpr uint64_t CorpusAlign = 64;
+
+class CorpusWriter
+{
+public:
+	template <typename Ty>
+	void AddSection(std::string_view name, int64_t branch, double min, double max, const std::vector<Ty>& data)
+	{
+		CorpusSection section{};
+		name.copy(section.name, sizeof(section.name) - 1);
+		section.elementSize = sizeof(Ty);
+		section.branch = (int32_t)branch;
+		section.min = min;
+		section.max = max;
+		section.count = data.size();
+		sections.push_back(section);
+
+		const char* bytes = reinterpret_cast<const char*>(data.data());
+		payloads.emplace_back(bytes, bytes + data.size() * sizeof(Ty));
+	}
+
+	bool Write(const std::string& path)
+	{
+		CorpusHeader header{};
+		memcpy(header.magic, CorpusMagic, sizeof(header.magic));
+		header.version = CorpusVersion;
+		header.numSections = (uint32_t)sections.size();
+
+		uint64_t offset = sizeof(CorpusHeader) + sections.size() * sizeof(CorpusSection);
+		for (size_t i = 0; i < sections.size(); i++)
+		{
+			offset = (offset + CorpusAlign - 1) / CorpusAlign * CorpusAlign;
+			sections[i].offset = offset;
+			offset += payloads[i].size();
+		}
+
+		std::ofstream file{ path, std::ios::binary };
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(sections.data()), (std::streamsize)(sections.size() * sizeof(CorpusSection)));
+		for (size_t i = 0; i < sections.size(); i++)
+		{
+			static constexpr char padding[CorpusAlign] = {};
+			file.write(padding, (std::streamsize)(sections[i].offset - (uint64_t)file.tellp()));
+			file.write(payloads[i].data(), (std::streamsize)payloads[i].size());
+		}
+
+		return (bool)file.flush();
+	}
+
+protected:
+	std::vector<CorpusSection> sections;
+	std::vector<std::vector<char>> payloads;
+};
+
+class Corpus
+{
+public:
+	Corpus() = default;
+
+	~Corpus()
+	{
+#ifndef _WIN32
+		if (mapping)
+			munmap(mapping, size);
+#endif
+	}
+
+	Corpus(const Corpus&) = delete;
+	Corpus& operator=(const Corpus&) = delete;
+
+	bool Open(const std::string& path)
+	{
+		if (!Load(path))
+		{
+			std::cerr << std::format("Could not read corpus {}\n", path);
+			return false;
+		}
+
+		const CorpusHeader* header = reinterpret_cast<const CorpusHeader*>(data);
+		if (size < sizeof(CorpusHeader) || memcmp(header->magic, CorpusMagic, sizeof(CorpusMagic)) != 0 || header->version != CorpusVersion)
+		{
+			std::cerr << std::format("{} is not a version {} corpus\n", path, CorpusVersion);
+			return false;
+		}
+
+		const CorpusSection* first = reinterpret_cast<const CorpusSection*>(data + sizeof(CorpusHeader));
+		if (sizeof(CorpusHeader) + header->numSections * sizeof(CorpusSection) > size)
+		{
+			std::cerr << std::format("Corpus {} is truncated\n", path);
+			return false;
+		}
+		sections.assign(first, first + header->numSections);
+
+		for (const CorpusSection& section : sections)
+		{
+			if (section.offset % CorpusAlign || section.offset + section.count * section.elementSize > size)
+			{
+				std::cerr << std::format("Corpus {} is truncated\n", path);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const std::vector<CorpusSection>& GetSections() const
+	{
+		return sections;
+	}
+
+	// Inputs of a section, empty if the corpus has no such section
+	template <typename Ty>
+	std::span<const Ty> Find(std::string_view name, int64_t branch, double min, double max) const
+	{
+		for (const CorpusSection& section : sections)
+		{
+			if (section.elementSize != sizeof(Ty) || section.branch != branch || name != section.name)
+				continue;
+			if (std::abs(section.min - min) > 1e-9 || std::abs(section.max - max) > 1e-9)
+				continue;
+
+			return { reinterpret_cast<const Ty*>(data + section.offset), (size_t)section.count };
+		}
+		return {};
+	}
+
+	// Inputs of the first section with this name and branch, for sets which aren't split by range
+	template <typename Ty>
+	std::span<const Ty> Find(std::string_view name, int64_t branch) const
+	{
+		for (const CorpusSection& section : sections)
+		{
+			if (section.elementSize == sizeof(Ty) && section.branch == branch && name == section.name)
+				return { reinterpret_cast<const Ty*>(data + section.offset), (size_t)section.count };
+		}
+		return {};
+	}
+
+protected:
+	const char* data = nullptr;
+	size_t size = 0;
+	std::vector<CorpusSection> sections;
+#ifndef _WIN32
+	void* mapping = nullptr;
+#endif
+	std::vector<uint64_t> buffer; // Fallback storage, uint64_t for alignment
+
+	bool Load(const std::string& path)
+	{
+#ifndef _WIN32
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd >= 0)
+		{
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0)
+			{
+				void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (map != MAP_FAILED)
+				{
+					close(fd);
+					mapping = map;
+					data = static_cast<const char*>(map);
+					size = (size_t)st.st_size;
+					return true;
+				}
+			}
+			close(fd);
+		}
+#endif
+
+		// Read the whole file instead
+		std::ifstream file{ path, std::ios::binary | std::ios::ate };
+		if (!file)
+			return false;
+
+		size = (size_t)file.tellg();
+		buffer.resize((size + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(buffer.data()), (std::streamsize)size);
+		data = reinterpret_cast<const char*>(buffer.data());
+
+		return (bool)file;
+	}
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CYCLETIMER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLETIMER_RDTSC 1
+#else
+#define CYCLETIMER_RDTSC 0
+#endif
+
+// Low overhead timestamps for timing single calls. On x86 this reads the invariant TSC, fenced so
+// the timed work can't be reordered across the read, elsewhere it falls back to the steady clock
+// in nanoseconds. Ticks are converted to seconds with a one-off calibration against the steady clock.
+class CycleTimer
+{
+public:
+	static inline uint64_t Now()
+	{
+#if CYCLETIMER_RDTSC
+		_mm_lfence();
+		uint64_t t = __rdtsc();
+		_mm_lfence();
+		return t;
+#else
+		using namespace std::chrono;
+		return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	static double SecondsPerTick()
+	{
+		static const double secondsPerTick = Calibrate();
+		return secondsPerTick;
+	}
+
+	// Ticks taken by back to back reads, subtracted from each sample
+	static uint64_t Overhead()
+	{
+		static const uint64_t overhead = MeasureOverhead();
+		return overhead;
+	}
+
+private:
+	static double Calibrate()
+	{
+#if CYCLETIMER_RDTSC
+		using Clock = std::chrono::steady_clock;
+		Clock::time_point start = Clock::now();
+		uint64_t startTicks = Now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		uint64_t endTicks = Now();
+		Clock::time_point end = Clock::now();
+
+		return std::chrono::duration<double>(end - start).count() / (double)(endTicks - startTicks);
+#else
+		return 1e-9;
+#endif
+	}
+
+	static uint64_t MeasureOverhead()
+	{
+		uint64_t overhead = UINT64_MAX;
+		for (size_t i = 0; i < 1000; i++)
+		{
+			uint64_t start = Now();
+			uint64_t end = Now();
+			overhead = std::min(overhead, end - start);
+		}
+		return overhead;
+	}
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <cmath>
+
+// Maps a uniform variable onto inputs which approach -1/e exponentially
+inline float ExpMapW0(float x)
+{
+	static constexpr float EM_UP = -0.36787942f;
+	return EM_UP + exp(x);
+}
+
+inline float ExpMapWm1(float x)
+{
+	static constexpr float EM_UP = -0.36787942f;
+	return EM_UP / (1 + exp(x));
+}
+
+inline double ExpMapW0(double x)
+{
+	static constexpr double EM_UP = -0.3678794411714423;
+	return EM_UP + exp(x);
+}
+
+inline double ExpMapWm1(double x)
+{
+	static constexpr double EM_UP = -0.3678794411714423;
+	static constexpr double EM_SCALE = -7.0954741622847041390e-23;
+	if (x < 700)
+		return EM_UP / (1 + exp(x));
+	
+	return EM_SCALE / (1 + exp(x - 50));
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <bit>
+#include <algorithm>
+
+/*
+Log-linear latency histogram in the style of HdrHistogram
+
+Values below 2^SubBits are counted exactly, above that every power of two is split into 2^SubBits
+equal buckets, so any recorded value is known to within a relative error of 2^-SubBits over the
+full 64-bit range with a fixed, small footprint. Percentiles report the upper edge of the bucket
+holding the requested rank and are therefore never optimistic. The maximum is tracked exactly.
+*/
+class LatencyHistogram
+{
+public:
+	// === Parameters ===
+	static constexpr int SubBits = 5;
+	// ==================
+
+	static constexpr uint64_t SubCount = (uint64_t)1 << SubBits;
+	static constexpr size_t NumBuckets = (64 - SubBits + 1) * SubCount;
+
+	LatencyHistogram()
+		: buckets(NumBuckets) {}
+
+	void Record(uint64_t value)
+	{
+		buckets[Index(value)]++;
+		count++;
+		max = std::max(max, value);
+	}
+
+	void Merge(const LatencyHistogram& other)
+	{
+		for (size_t i = 0; i < NumBuckets; i++)
+			buckets[i] += other.buckets[i];
+		count += other.count;
+		max = std::max(max, other.max);
+	}
+
+	// Smallest bucket edge which at least a fraction q of the samples are below or equal to
+	uint64_t Percentile(double q) const
+	{
+		if (count == 0)
+			return 0;
+
+		uint64_t rank = std::max<uint64_t>((uint64_t)(q * (double)count + 0.5), 1);
+		uint64_t seen = 0;
+		for (size_t i = 0; i < NumBuckets; i++)
+		{
+			seen += buckets[i];
+			if (seen >= rank)
+				return std::min(UpperEdge(i), max);
+		}
+		return max;
+	}
+
+	uint64_t GetCount() const
+	{
+		return count;
+	}
+
+	uint64_t GetMax() const
+	{
+		return max;
+	}
+
+protected:
+	std::vector<uint64_t> buckets;
+	uint64_t count = 0;
+	uint64_t max = 0;
+
+	static size_t Index(uint64_t value)
+	{
+		if (value < SubCount)
+			return (size_t)value;
+
+		// Leading SubBits + 1 bits of the value select the bucket within its power of two
+		int magnitude = std::bit_width(value) - 1;
+		int shift = magnitude - SubBits;
+		return (size_t)(shift + 1) * SubCount + (size_t)((value >> shift) - SubCount);
+	}
+
+	static uint64_t UpperEdge(size_t idx)
+	{
+		size_t group = idx / SubCount;
+		uint64_t sub = idx % SubCount;
+		if (group == 0)
+			return sub;
+
+		int shift = (int)group - 1;
+		uint64_t low = (SubCount + sub) << shift;
+		return low + (((uint64_t)1 << shift) - 1);
+	}
+};
@@ -0,0 +1,228 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <optional>
+#include <variant>
+#include <format>
+#include <cctype>
+#include <cstdlib>
+
+// Minimal JSON document model for benchmark results, enough to write and read back what bench emits
+struct JsonValue
+{
+	using Array = std::vector<JsonValue>;
+	using Object = std::map<std::string, JsonValue>;
+
+	std::variant<std::nullptr_t, bool, double, std::string, Array, Object> value = nullptr;
+
+	bool IsBool() const { return std::holds_alternative<bool>(value); }
+	bool IsNumber() const { return std::holds_alternative<double>(value); }
+	bool IsString() const { return std::holds_alternative<std::string>(value); }
+	bool IsArray() const { return std::holds_alternative<Array>(value); }
+	bool IsObject() const { return std::holds_alternative<Object>(value); }
+
+	bool AsBool() const { return IsBool() && std::get<bool>(value); }
+	double AsNumber() const { return IsNumber() ? std::get<double>(value) : 0.0; }
+	const std::string& AsString() const { static const std::string empty; return IsString() ? std::get<std::string>(value) : empty; }
+	const Array& AsArray() const { static const Array empty; return IsArray() ? std::get<Array>(value) : empty; }
+
+	// Member lookup, a null value if missing
+	const JsonValue& operator[](const std::string& key) const
+	{
+		static const JsonValue null;
+		if (!IsObject())
+			return null;
+		const Object& object = std::get<Object>(value);
+		auto it = object.find(key);
+		return (it != object.end()) ? it->second : null;
+	}
+};
+
+inline std::string JsonEscape(std::string_view str)
+{
+	std::string out = "\"";
+	for (char c : str)
+	{
+		switch (c)
+		{
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		case '\n': out += "\\n"; break;
+		case '\t': out += "\\t"; break;
+		default:
+			if ((unsigned char)c < 0x20)
+				out += std::format("\\u{:04x}", (int)c);
+			else
+				out += c;
+		}
+	}
+	return out + '"';
+}
+
+class JsonParser
+{
+public:
+	JsonParser(std::string_view text_)
+		: text(text_) {}
+
+	// Parses a whole document, empty on malformed input
+	std::optional<JsonValue> Parse()
+	{
+		std::optional<JsonValue> value = ParseValue();
+		SkipSpace();
+		if (pos != text.size())
+			return std::nullopt;
+		return value;
+	}
+
+protected:
+	std::string_view text;
+	size_t pos = 0;
+
+	void SkipSpace()
+	{
+		while (pos < text.size() && std::isspace((unsigned char)text[pos]))
+			pos++;
+	}
+
+	bool Consume(char c)
+	{
+		SkipSpace();
+		if (pos < text.size() && text[pos] == c)
+		{
+			pos++;
+			return true;
+		}
+		return false;
+	}
+
+	bool ConsumeWord(std::string_view word)
+	{
+		if (text.substr(pos, word.size()) != word)
+			return false;
+		pos += word.size();
+		return true;
+	}
+
+	std::optional<std::string> ParseString()
+	{
+		if (!Consume('"'))
+			return std::nullopt;
+
+		std::string out;
+		while (pos < text.size() && text[pos] != '"')
+		{
+			char c = text[pos++];
+			if (c != '\\')
+			{
+				out += c;
+				continue;
+			}
+			if (pos >= text.size())
+				return std::nullopt;
+
+			char escape = text[pos++];
+			switch (escape)
+			{
+			case 'n': out += '\n'; break;
+			case 't': out += '\t'; break;
+			case 'r': out += '\r'; break;
+			case 'b': out += '\b'; break;
+			case 'f': out += '\f'; break;
+			case 'u':
+			{
+				// Only ASCII is ever written
+				if (pos + 4 > text.size())
+					return std::nullopt;
+				out += (char)std::strtol(std::string(text.substr(pos, 4)).c_str(), nullptr, 16);
+				pos += 4;
+				break;
+			}
+			default: out += escape;
+			}
+		}
+		if (pos >= text.size())
+			return std::nullopt;
+		pos++;
+
+		return out;
+	}
+
+	std::optional<JsonValue> ParseValue()
+	{
+		SkipSpace();
+		if (pos >= text.size())
+			return std::nullopt;
+
+		JsonValue result;
+		char c = text[pos];
+		if (c == '{')
+		{
+			pos++;
+			JsonValue::Object object;
+			if (!Consume('}'))
+			{
+				do
+				{
+					std::optional<std::string> key = ParseString();
+					if (!key || !Consume(':'))
+						return std::nullopt;
+					std::optional<JsonValue> member = ParseValue();
+					if (!member)
+						return std::nullopt;
+					object[*key] = std::move(*member);
+				} while (Consume(','));
+
+				if (!Consume('}'))
+					return std::nullopt;
+			}
+			result.value = std::move(object);
+		}
+		else if (c == '[')
+		{
+			pos++;
+			JsonValue::Array array;
+			if (!Consume(']'))
+			{
+				do
+				{
+					std::optional<JsonValue> element = ParseValue();
+					if (!element)
+						return std::nullopt;
+					array.push_back(std::move(*element));
+				} while (Consume(','));
+
+				if (!Consume(']'))
+					return std::nullopt;
+			}
+			result.value = std::move(array);
+		}
+		else if (c == '"')
+		{
+			std::optional<std::string> str = ParseString();
+			if (!str)
+				return std::nullopt;
+			result.value = std::move(*str);
+		}
+		else if (ConsumeWord("true"))
+			result.value = true;
+		else if (ConsumeWord("false"))
+			result.value = false;
+		else if (ConsumeWord("null"))
+			result.value = nullptr;
+		else
+		{
+			std::string number{ text.substr(pos, std::min<size_t>(64, text.size() - pos)) };
+			char* end;
+			double d = std::strtod(number.c_str(), &end);
+			if (end == number.c_str())
+				return std::nullopt;
+			pos += (size_t)(end - number.c_str());
+			result.value = d;
+		}
+
+		return result;
+	}
+};
@@ -0,0 +1,144 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <array>
+#include <string>
+#include <format>
+#include <utility>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+/*
+Hardware performance counters for the calling thread, through perf_event_open on Linux
+
+Each counter is opened on its own so a PMU without one of the events (or a VM exposing only some)
+still provides the rest. Counts are scaled by time enabled / time running, so they stay meaningful
+if the kernel has to multiplex. Unavailable counters read as NaN, and on other platforms, or when
+perf_event_paranoid forbids user counters, nothing is available and the benchmark runs as before.
+*/
+class PerfCounters
+{
+public:
+	enum Counter
+	{
+		Cycles,
+		Instructions,
+		BranchMisses,
+		L1DMisses,
+		LLCMisses,
+		NumCounters
+	};
+
+	static constexpr const char* Names[NumCounters] = { "Cycles", "Instructions", "Branch Misses", "L1D Misses", "LLC Misses" };
+
+	using Counts = std::array<double, NumCounters>;
+
+	PerfCounters()
+	{
+		fds.fill(-1);
+#ifdef __linux__
+		static constexpr uint64_t L1DReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		static constexpr std::pair<uint32_t, uint64_t> Events[NumCounters] = {
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+			{ PERF_TYPE_HW_CACHE, L1DReadMiss },
+			{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES }
+		};
+
+		for (size_t i = 0; i < NumCounters; i++)
+		{
+			perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = Events[i].first;
+			attr.config = Events[i].second;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+			fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+			if (fds[i] < 0 && error.empty())
+				error = std::format("perf_event_open failed for {}: {}", Names[i], strerror(errno));
+		}
+#else
+		error = "Hardware counters are only supported on Linux";
+#endif
+	}
+
+	~PerfCounters()
+	{
+#ifdef __linux__
+		for (int fd : fds)
+			if (fd >= 0) close(fd);
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	bool IsAvailable() const
+	{
+		for (int fd : fds)
+			if (fd >= 0) return true;
+		return false;
+	}
+
+	// Reason the first unavailable counter could not be opened
+	const std::string& GetError() const
+	{
+		return error;
+	}
+
+	void Start()
+	{
+#ifdef __linux__
+		for (int fd : fds)
+		{
+			if (fd < 0) continue;
+			ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	void Stop()
+	{
+#ifdef __linux__
+		for (int fd : fds)
+			if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+	}
+
+	// Counts between the last Start and Stop
+	Counts Read() const
+	{
+		Counts counts;
+		counts.fill(NAN);
+#ifdef __linux__
+		for (size_t i = 0; i < NumCounters; i++)
+		{
+			if (fds[i] < 0) continue;
+
+			// value, time enabled, time running
+			uint64_t values[3];
+			if (read(fds[i], values, sizeof(values)) != sizeof(values) || values[2] == 0)
+				continue;
+			counts[i] = (double)values[0] * ((double)values[1] / (double)values[2]);
+		}
+#endif
+		return counts;
+	}
+
+protected:
+	std::array<int, NumCounters> fds;
+	std::string error;
+};
@@ -2,97 +2,179 @@
 #include <vector>
 #include <fstream>
 #include <random>
+#include <tuple>
+#include <format>
+#include <string>
+#include <cmath>
+#include <span>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/wait.h>
+#define BENCH_FORK 1
+#else
+#define BENCH_FORK 0
+#endif
 
 #include <ReferenceLambertW.h>
 
 #define TIMER_NPRINT
 #include "Timer.h"
+#include "ExpMap.h"
+#include "CycleTimer.h"
+#include "Histogram.h"
+#include "PerfCounters.h"
+#include "BuildInfo.h"
+#include "Json.h"
+#include "Corpus.h"
+#include "../engines/Engine.h"
 
 // === Bench Config ===
 #define BRANCH Wm1
+#if REFERENCEW_BENCH_FLOAT
+using BenchTy = float;
+#else
 using BenchTy = double;
+#endif
 // ====================
 
 #define DOMAP(x) ExpMap##x
 #define MAP(x) DOMAP(x)
+#define DOSTR(x) #x
+#define STR(x) DOSTR(x)
+
+// Results collected for bench.json
+struct BinResult
+{
+	std::string branch;
+	BenchTy min, max;
+	std::vector<double> samples; // Seconds per evaluation, one per repeat
+	PerfCounters::Counts counters; // Per evaluation
+};
+
+struct LatencyResult
+{
+	std::string branch;
+	bool isBranch; // Over all bins of the branch rather than one
+	BenchTy min, max;
+	uint64_t count;
+	double p50, p90, p99, p999, maxLatency; // Nanoseconds
+};
+
+struct SetResult
+{
+	std::string name, branch;
+	std::vector<double> samples; // Seconds per evaluation, one per repeat
+};
 
 template <typename Ty>
 using Function1D = Ty(*)(Ty);
 
+constexpr int64_t BenchBranch = (std::string_view{ STR(BRANCH) } == "W0") ? 0 : -1;
+
+// Inputs from --corpus, identical across runs and machines
+Corpus corpus;
+
+// Evaluator backend from --engine
+std::string engineName = "reference";
+
+template <typename Ty>
+Engine<Ty>& GetEngine()
+{
+	static std::unique_ptr<Engine<Ty>> engine = MakeEngine<Ty>(engineName);
+	return *engine;
+}
+
+// Inputs for an exp-mapped bin, taken from the corpus if it has the bin, otherwise generated into storage
 template <typename Ty>
-double RunBench(Ty min, Ty max, Function1D<Ty> map, size_t num)
+std::span<const Ty> GetInputs(int64_t branch, Ty min, Ty max, Function1D<Ty> map, size_t num, std::vector<Ty>& storage)
 {
+	std::span<const Ty> data = corpus.Find<Ty>("expmap", branch, min, max);
+	if (!data.empty())
+		return data.first(std::min(num, data.size()));
+
 	static std::mt19937_64 gen{ std::random_device{}() };
 	std::uniform_real_distribution<Ty> dist{ min, max };
 
-	// Prepare data
-	std::vector<Ty> data;
-	data.reserve(num);
+	storage.clear();
+	storage.reserve(num);
 	for (size_t i = 0; i < num; i++)
-		data.push_back(map(dist(gen)));
+		storage.push_back(map(dist(gen)));
+
+	return storage;
+}
+
+template <typename Ty>
+std::tuple<double, PerfCounters::Counts> RunBench(Ty min, Ty max, Function1D<Ty> map, size_t num, PerfCounters& counters)
+{
+	// Prepare data
+	std::vector<Ty> storage;
+	std::span<const Ty> data = GetInputs(BenchBranch, min, max, map, num, storage);
 
-	// Create evaluator
-	static std::conditional_t<std::is_same_v<Ty, float>, ReferenceWf, ReferenceW> evaluator;
+	// Get evaluator
+	Engine<Ty>& evaluator = GetEngine<Ty>();
 
 	// Run timing
 	Ty _ = 0;
+	counters.Start();
 	Timer t;
 	for (Ty d : data)
 		_ += evaluator.BRANCH(d).inf;
 	t.Stop();
+	counters.Stop();
+
+	return { t.GetSeconds(), counters.Read() };
+}
+
+// Times every call individually, for the latency distribution rather than the mean
+template <typename Ty>
+void RunLatency(int64_t branch, Ty min, Ty max, Function1D<Ty> map, size_t num, LatencyHistogram& hist)
+{
+	// Prepare data
+	std::vector<Ty> storage;
+	std::span<const Ty> data = GetInputs(branch, min, max, map, num, storage);
+
+	// Get evaluator
+	Engine<Ty>& evaluator = GetEngine<Ty>();
+
+	// Run timing
+	uint64_t overhead = CycleTimer::Overhead();
+	Ty _ = 0;
+	for (Ty d : data)
+	{
+		uint64_t start = CycleTimer::Now();
+		auto res = (branch == 0) ? evaluator.W0(d) : evaluator.Wm1(d);
+		uint64_t end = CycleTimer::Now();
 
-	return t.GetSeconds();
+		_ += res.inf;
+		hist.Record((end - start > overhead) ? end - start - overhead : 0);
+	}
 }
 
 template <typename Ty>
-std::tuple<double, size_t, double> RunStats(Ty min, Ty max, Function1D<Ty> map, size_t num)
+std::tuple<double, size_t, double, double, double> RunStats(Ty min, Ty max, Function1D<Ty> map, size_t num)
 {
 #if REFERENCEW_STATS
 	static std::mt19937_64 gen{ std::random_device{}() };
 	std::uniform_real_distribution<Ty> dist{ min, max };
 
-	// Create evaluator
-	std::conditional_t<std::is_same_v<Ty, float>, ReferenceWf, ReferenceW> evaluator;
+	// Create evaluator, with the search method of --engine so stats compare across methods
+	BasicReferenceW<Ty> evaluator{ GetSearchMethod(engineName) };
 
 	// Track stats
 	for (size_t i = 0; i < num; i++)
 		evaluator.BRANCH(map(dist(gen)));
 
-	return { evaluator.GetHighPrecRate(), evaluator.GetMaxBisections(), evaluator.GetAvgBisections() };
+	double expReuseRate = (double)evaluator.GetNumExpReuse() / (evaluator.GetTotalBisections() - num);
+	double avgContractions = (double)evaluator.GetNumContractions() / num;
+	return { evaluator.GetHighPrecRate(), evaluator.GetMaxBisections(), evaluator.GetAvgBisections(), expReuseRate, avgContractions };
 #else
-	return { 0.0, 0, 0.0 };
+	return { 0.0, 0, 0.0, 0.0, 0.0 };
 #endif
 }
 
-float ExpMapW0(float x)
-{
-	static constexpr float EM_UP = -0.36787942f;
-	return EM_UP + exp(x);
-}
-
-float ExpMapWm1(float x)
-{
-	static constexpr float EM_UP = -0.36787942f;
-	return EM_UP / (1 + exp(x));
-}
-
-double ExpMapW0(double x)
-{
-	static constexpr double EM_UP = -0.3678794411714423;
-	return EM_UP + exp(x);
-}
-
-double ExpMapWm1(double x)
-{
-	static constexpr double EM_UP = -0.3678794411714423;
-	static constexpr double EM_SCALE = -7.0954741622847041390e-23;
-	if (x < 700)
-		return EM_UP / (1 + exp(x));
-	
-	return EM_SCALE / (1 + exp(x - 50));
-}
-
-void Bench()
+void Bench(std::vector<BinResult>& results)
 {
 	// === Parameters ===
 	static constexpr size_t Num = 10'000;
@@ -103,21 +185,244 @@ void Bench()
 	// ==================
 
 	std::ofstream file{ "bench.csv" };
+	std::ofstream countersFile{ "counters.csv" };
+
+	PerfCounters counters;
+	if (!counters.IsAvailable())
+		std::cout << std::format("Hardware counters unavailable ({}), counters.csv will be empty\n", counters.GetError());
 
 	file << "Min,Max,Time\n";
+	countersFile << "Min,Max";
+	for (const char* name : PerfCounters::Names)
+		countersFile << ',' << name;
+	countersFile << ",IPC\n";
+
 	for (BenchTy min = binMin; min < binMax; min += binWidth)
 	{
 		BenchTy max = min + binWidth;
 		double time = 0.0;
+		PerfCounters::Counts counts{};
+		std::vector<double> samples;
 		for (size_t i = 0; i < Repeats; i++)
-			time += RunBench(min, max, ExpMapWm1, Num);
+		{
+			auto [seconds, repeatCounts] = RunBench(min, max, MAP(BRANCH), Num, counters);
+			time += seconds;
+			samples.push_back(seconds / Num);
+			for (size_t c = 0; c < PerfCounters::NumCounters; c++)
+				counts[c] += repeatCounts[c];
+		}
 		time /= Repeats;
 
+		for (double& count : counts)
+			count /= Repeats * Num;
+		results.push_back({ STR(BRANCH), min, max, std::move(samples), counts });
+
 		file << std::format("{:.3f},{:.3f},{:.10f}\n", min, max, time);
+
+		// Per evaluation, unavailable counters are left blank
+		countersFile << std::format("{:.3f},{:.3f}", min, max);
+		for (double count : counts)
+			countersFile << (std::isnan(count) ? std::string(",") : std::format(",{:.2f}", count));
+		double ipc = counts[PerfCounters::Instructions] / counts[PerfCounters::Cycles];
+		countersFile << (std::isnan(ipc) ? std::string(",\n") : std::format(",{:.3f}\n", ipc));
+
 		std::cout << min << " - " << max << '\n';
 	}
 }
 
+void Latency(std::vector<LatencyResult>& results)
+{
+	// === Parameters ===
+	static constexpr size_t Num = 10'000;
+	static constexpr size_t Repeats = 30;
+	BenchTy binMin = -35.5;
+	BenchTy binMax = 10;
+	BenchTy binWidth = 0.5;
+	// ==================
+
+	std::ofstream file{ "latency.csv" };
+	double nsPerTick = CycleTimer::SecondsPerTick() * 1e9;
+
+	auto record = [&](int64_t branch, bool isBranch, BenchTy min, BenchTy max, const LatencyHistogram& hist)
+	{
+		auto ns = [&](uint64_t ticks) { return (double)ticks * nsPerTick; };
+		LatencyResult result{ (branch == 0) ? "W0" : "Wm1", isBranch, min, max, hist.GetCount(),
+			ns(hist.Percentile(0.5)), ns(hist.Percentile(0.9)), ns(hist.Percentile(0.99)), ns(hist.Percentile(0.999)), ns(hist.GetMax()) };
+		file << std::format("{},{},{:.3f},{:.3f},{},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f}\n", result.branch, isBranch ? "branch" : "bin", min, max, result.count,
+			result.p50, result.p90, result.p99, result.p999, result.maxLatency);
+		results.push_back(result);
+	};
+
+	file << "Branch,Scope,Min,Max,Count,P50 (ns),P90 (ns),P99 (ns),P99.9 (ns),Max (ns)\n";
+	for (int64_t branch : { 0, -1 })
+	{
+		LatencyHistogram branchHist;
+		for (BenchTy min = binMin; min < binMax; min += binWidth)
+		{
+			BenchTy max = min + binWidth;
+			Function1D<BenchTy> map = ExpMapWm1;
+			if (branch == 0) map = ExpMapW0;
+			LatencyHistogram hist;
+			for (size_t i = 0; i < Repeats; i++)
+				RunLatency(branch, min, max, map, Num, hist);
+
+			record(branch, false, min, max, hist);
+			branchHist.Merge(hist);
+			std::cout << min << " - " << max << '\n';
+		}
+
+		// All bins of the branch, equally weighted as every bin has the same number of calls
+		record(branch, true, binMin, binMax, branchHist);
+	}
+}
+
+// Times the corpus sets which cover the whole domain rather than one bin, skipped without a corpus
+void Sets(std::vector<SetResult>& results)
+{
+	// === Parameters ===
+	static constexpr size_t Num = 100'000;
+	static constexpr size_t Repeats = 30;
+	static constexpr const char* Names[] = { "reciprocal", "nearbranch" };
+	// ==================
+
+	std::ofstream file{ "sets.csv" };
+	Engine<BenchTy>& evaluator = GetEngine<BenchTy>();
+
+	file << "Set,Count,Time\n";
+	for (const char* name : Names)
+	{
+		std::span<const BenchTy> data = corpus.Find<BenchTy>(name, BenchBranch);
+		if (data.empty())
+			continue;
+		data = data.first(std::min(Num, data.size()));
+
+		double time = 0.0;
+		std::vector<double> samples;
+		for (size_t i = 0; i < Repeats; i++)
+		{
+			BenchTy _ = 0;
+			Timer t;
+			for (BenchTy d : data)
+				_ += evaluator.BRANCH(d).inf;
+			t.Stop();
+
+			time += t.GetSeconds();
+			samples.push_back(t.GetSeconds() / data.size());
+		}
+		time /= Repeats;
+
+		results.push_back({ name, STR(BRANCH), std::move(samples) });
+		file << std::format("{},{},{:.10f}\n", name, data.size(), time);
+		std::cout << name << '\n';
+	}
+}
+
+// Ticks spent in the first calls into a fresh evaluator
+struct FirstCall
+{
+	uint64_t warmup, first, second;
+};
+
+// Evaluates x twice on a new evaluator, after Warmup if warm. Where fork is available this runs in
+// a child process, so every measurement starts from a process which has never evaluated; otherwise
+// it runs in process and only the first measurement of the run is truly cold.
+template <typename Ty>
+FirstCall MeasureFirstCall(int64_t branch, Ty x, bool warm)
+{
+	auto measure = [&]()
+	{
+		std::unique_ptr<Engine<Ty>> evaluator = MakeEngine<Ty>(engineName);
+		auto eval = [&]() { return (branch == 0) ? evaluator->W0(x) : evaluator->Wm1(x); };
+
+		uint64_t start = CycleTimer::Now();
+		if (warm)
+			evaluator->Warmup();
+		uint64_t warmed = CycleTimer::Now();
+		auto a = eval();
+		uint64_t first = CycleTimer::Now();
+		auto b = eval();
+		uint64_t second = CycleTimer::Now();
+
+		volatile Ty _ = a.inf + b.inf;
+		(void)_;
+		return FirstCall{ warmed - start, first - warmed, second - first };
+	};
+
+#if BENCH_FORK
+	int fds[2];
+	if (pipe(fds) == 0)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			close(fds[0]);
+			FirstCall result = measure();
+			bool ok = write(fds[1], &result, sizeof(result)) == (ssize_t)sizeof(result);
+			_exit(ok ? 0 : 1);
+		}
+
+		close(fds[1]);
+		FirstCall result{};
+		bool ok = pid > 0 && read(fds[0], &result, sizeof(result)) == (ssize_t)sizeof(result);
+		close(fds[0]);
+		if (pid > 0)
+			waitpid(pid, nullptr, 0);
+		if (ok)
+			return result;
+	}
+	std::cerr << "fork failed, measuring in process\n";
+#endif
+	return measure();
+}
+
+// First call latency of a fresh process with and without Warmup, so the cost can be moved to startup
+// Must run before anything evaluates in this process, or the children inherit its warm caches
+void ColdStart()
+{
+	// === Parameters ===
+	static constexpr size_t Trials = 20;
+	static constexpr BenchTy Points[] = { -30, -10, -2, 2, 9 }; // Before the exp map
+	// ==================
+
+	std::ofstream file{ "coldstart.csv" };
+	double usPerTick = CycleTimer::SecondsPerTick() * 1e6;
+	uint64_t overhead = CycleTimer::Overhead();
+	auto us = [&](uint64_t ticks) { return (double)((ticks > overhead) ? ticks - overhead : 0) * usPerTick; };
+
+	file << "Branch,x,Mode,Warmup (us),First Call (us),Second Call (us)\n";
+	for (int64_t branch : { 0, -1 })
+	{
+		for (BenchTy t : Points)
+		{
+			BenchTy x = (branch == 0) ? ExpMapW0(t) : ExpMapWm1(t);
+			for (bool warm : { false, true })
+			{
+				// Medians over trials
+				std::vector<FirstCall> trials;
+				for (size_t i = 0; i < Trials; i++)
+					trials.push_back(MeasureFirstCall(branch, x, warm));
+
+				auto median = [&](uint64_t FirstCall::* field)
+				{
+					std::vector<uint64_t> values;
+					for (const FirstCall& trial : trials)
+						values.push_back(trial.*field);
+					std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+					return values[values.size() / 2];
+				};
+
+				const char* mode = warm ? "warm" : "cold";
+				double warmup = us(median(&FirstCall::warmup));
+				double first = us(median(&FirstCall::first));
+				double second = us(median(&FirstCall::second));
+				file << std::format("{},{:a},{},{:.3f},{:.3f},{:.3f}\n", (branch == 0) ? "W0" : "Wm1", x, mode, warmup, first, second);
+				std::cout << std::format("{} {:.6e} {}: first {:.1f}us, second {:.1f}us", (branch == 0) ? "W0" : "Wm1", x, mode, first, second);
+				std::cout << (warm ? std::format(", warmup {:.1f}us\n", warmup) : std::string("\n"));
+			}
+		}
+	}
+}
+
 void Stats()
 {
 #if REFERENCEW_STATS
@@ -130,21 +435,119 @@ void Stats()
 
 	std::ofstream file{ "stats.csv" };
 
-	file << "Min,Max,HighPrec Rate,Max Bisections,Average Bisections\n";
+	file << "Min,Max,HighPrec Rate,Max Bisections,Average Bisections,Exp Reuse Rate,Average Contractions\n";
 	for (BenchTy min = binMin; min < binMax; min += binWidth)
 	{
 		BenchTy max = min + binWidth;
-		auto [highPrecRate, maxBisections, avgBisections] = RunStats(min, max, MAP(BRANCH), Num);
+		auto [highPrecRate, maxBisections, avgBisections, expReuseRate, avgContractions] = RunStats(min, max, MAP(BRANCH), Num);
 
-		file << std::format("{:.3f},{:.3f},{:.10f},{},{:.10f}\n", min, max, highPrecRate, maxBisections, avgBisections);
+		file << std::format("{:.3f},{:.3f},{:.10f},{},{:.10f},{:.10f},{:.10f}\n", min, max, highPrecRate, maxBisections, avgBisections, expReuseRate, avgContractions);
 		file << std::flush;
 		std::cout << min << " - " << max << '\n';
 	}
 #endif
 }
 
-int main()
+// Machine readable results with the build they came from, compared between builds by compare
+void WriteJson(const std::string& path, const std::string& inputs, const std::vector<BinResult>& bins, const std::vector<LatencyResult>& latencies,
+	const std::vector<SetResult>& sets)
 {
-	Bench();
+	std::ofstream file{ path };
+	auto number = [](double d) { return std::isfinite(d) ? std::format("{:.6e}", d) : std::string("null"); };
+
+	file << "{\n";
+	file << "\t\"format\": \"ReferenceLambertW bench 1\",\n";
+	file << "\t\"build\": {\n";
+	file << std::format("\t\t\"compiler\": {},\n", JsonEscape(GetCompiler()));
+	file << std::format("\t\t\"flags\": {},\n", JsonEscape(REFERENCEW_BENCH_FLAGS));
+	file << std::format("\t\t\"config\": {},\n", JsonEscape(REFERENCEW_BENCH_CONFIG));
+	file << std::format("\t\t\"stats\": {},\n", GetStatsEnabled() ? "true" : "false");
+	file << std::format("\t\t\"type\": \"{}\"\n", std::is_same_v<BenchTy, float> ? "float" : "double");
+	file << "\t},\n";
+	file << std::format("\t\"cpu\": {},\n", JsonEscape(GetCpuModel()));
+	file << std::format("\t\"inputs\": {},\n", JsonEscape(inputs));
+	file << std::format("\t\"engine\": {},\n", JsonEscape(engineName));
+
+	file << "\t\"bins\": [";
+	for (size_t i = 0; i < bins.size(); i++)
+	{
+		const BinResult& bin = bins[i];
+		file << std::format("{}\n\t\t{{ \"branch\": \"{}\", \"min\": {:.3f}, \"max\": {:.3f}, \"samples\": [", (i == 0) ? "" : ",", bin.branch, bin.min, bin.max);
+		for (size_t j = 0; j < bin.samples.size(); j++)
+			file << ((j == 0) ? "" : ", ") << number(bin.samples[j]);
+		file << "], \"counters\": {";
+		for (size_t c = 0; c < PerfCounters::NumCounters; c++)
+			file << std::format("{}{}: {}", (c == 0) ? " " : ", ", JsonEscape(PerfCounters::Names[c]), number(bin.counters[c]));
+		file << " } }";
+	}
+	file << "\n\t],\n";
+
+	file << "\t\"latency\": [";
+	for (size_t i = 0; i < latencies.size(); i++)
+	{
+		const LatencyResult& l = latencies[i];
+		file << std::format("{}\n\t\t{{ \"branch\": \"{}\", \"scope\": \"{}\", \"min\": {:.3f}, \"max\": {:.3f}, \"count\": {}, \"p50\": {}, \"p90\": {}, \"p99\": {}, \"p999\": {}, \"maxLatency\": {} }}",
+			(i == 0) ? "" : ",", l.branch, l.isBranch ? "branch" : "bin", l.min, l.max, l.count, number(l.p50), number(l.p90), number(l.p99), number(l.p999), number(l.maxLatency));
+	}
+	file << "\n\t],\n";
+
+	file << "\t\"sets\": [";
+	for (size_t i = 0; i < sets.size(); i++)
+	{
+		const SetResult& set = sets[i];
+		file << std::format("{}\n\t\t{{ \"name\": \"{}\", \"branch\": \"{}\", \"samples\": [", (i == 0) ? "" : ",", set.name, set.branch);
+		for (size_t j = 0; j < set.samples.size(); j++)
+			file << ((j == 0) ? "" : ", ") << number(set.samples[j]);
+		file << "] }";
+	}
+	file << "\n\t]\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+	// bench [json path] [--corpus file] [--engine reference|illinois|newton|arb|mpfr] [--coldstart]
+	std::string jsonPath = "bench.json";
+	std::string inputs = "random";
+	bool coldStart = false;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg{ argv[i] };
+		if (arg == "--corpus" && i + 1 < argc)
+		{
+			inputs = argv[++i];
+			if (!corpus.Open(inputs))
+				return 1;
+		}
+		else if (arg == "--engine" && i + 1 < argc)
+		{
+			engineName = argv[++i];
+			if (!MakeEngine<BenchTy>(engineName))
+			{
+				std::cerr << std::format("Unknown engine: {}\n", engineName);
+				return 1;
+			}
+		}
+		else if (arg == "--coldstart")
+			coldStart = true;
+		else
+			jsonPath = arg;
+	}
+
+	if (coldStart)
+	{
+		ColdStart();
+		std::cout << "Results written to coldstart.csv\n";
+		return 0;
+	}
+
+	std::vector<BinResult> bins;
+	std::vector<LatencyResult> latencies;
+	std::vector<SetResult> sets;
+	Bench(bins);
+	Latency(latencies);
+	Sets(sets);
 	//Stats();
+
+	WriteJson(jsonPath, inputs, bins, latencies, sets);
+	std::cout << std::format("Results written to {}\n", jsonPath);
 }
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <tuple>
+#include <optional>
+#include <algorithm>
+#include <format>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+
+#include "Json.h"
+
+/*
+Benchmark regression check
+
+Compares two bench.json files bin by bin, and the corpus sets by name. Each bin or set holds one
+time per evaluation for every repeat, and the candidate is tested against the baseline with a one-sided Mann-Whitney U test, which makes
+no assumption about the shape of the timing distribution (they are usually skewed by interrupts and
+frequency changes). A bin regresses if the candidate is significantly slower and its median is
+slower by more than the threshold.
+
+Each branch also gets an aggregate verdict over all its bins, from the geometric mean of the median
+ratios and a one-sided Wilcoxon signed-rank test on their logs, which catches a small slowdown
+spread over every bin that no single bin shows. Latency percentiles are aggregated the same way per
+branch and percentile, against their own threshold as tails are noisier than medians. Exits with 1
+if any bin, set or aggregate regressed.
+
+Results built with and without REFERENCEW_STATS aren't compared, as the counters change the timings.
+*/
+
+// === Parameters ===
+constexpr double defaultThreshold = 0.05;	// Relative slowdown of the median
+constexpr double defaultLatencyThreshold = 0.10;	// Relative slowdown of a latency percentile
+constexpr double defaultAlpha = 0.01;		// Significance level
+constexpr const char* LatencyPercentiles[] = { "p50", "p90", "p99", "p999" }; // maxLatency is a single extreme, reported by bench only
+// ==================
+
+std::optional<JsonValue> ReadResults(const std::string& path)
+{
+	std::ifstream file{ path };
+	if (!file)
+	{
+		std::cerr << std::format("Could not open {}\n", path);
+		return std::nullopt;
+	}
+
+	std::stringstream text;
+	text << file.rdbuf();
+	std::optional<JsonValue> results = JsonParser{ text.str() }.Parse();
+	if (!results || (*results)["format"].AsString() != "ReferenceLambertW bench 1")
+	{
+		std::cerr << std::format("{} is not a benchmark result file\n", path);
+		return std::nullopt;
+	}
+
+	return results;
+}
+
+double Median(std::vector<double> samples)
+{
+	std::sort(samples.begin(), samples.end());
+	size_t n = samples.size();
+	return (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+}
+
+// p-value of the alternative that candidate samples tend to be larger than baseline samples,
+// normal approximation with tie and continuity corrections
+double MannWhitneyGreater(const std::vector<double>& baseline, const std::vector<double>& candidate)
+{
+	double n1 = (double)candidate.size(), n2 = (double)baseline.size();
+
+	// Joint ranks, ties get their average rank
+	std::vector<std::pair<double, bool>> all;
+	for (double x : candidate) all.push_back({ x, true });
+	for (double x : baseline) all.push_back({ x, false });
+	std::sort(all.begin(), all.end());
+
+	double rankSum = 0.0, tieTerm = 0.0;
+	for (size_t i = 0; i < all.size();)
+	{
+		size_t j = i;
+		while (j < all.size() && all[j].first == all[i].first)
+			j++;
+
+		double rank = 0.5 * (double)(i + j + 1);
+		for (size_t k = i; k < j; k++)
+			if (all[k].second) rankSum += rank;
+
+		double t = (double)(j - i);
+		tieTerm += t * t * t - t;
+		i = j;
+	}
+
+	double n = n1 + n2;
+	double u = rankSum - n1 * (n1 + 1) / 2;
+	double mean = n1 * n2 / 2;
+	double variance = n1 * n2 / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+	if (variance <= 0)
+		return 1.0;
+
+	double z = (u - mean - 0.5) / std::sqrt(variance);
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+// p-value of the alternative that the differences tend to be positive, Wilcoxon signed-rank test with
+// the normal approximation, zeros dropped and ties given their average rank
+double WilcoxonGreater(const std::vector<double>& diffs)
+{
+	std::vector<double> nonZero;
+	for (double d : diffs)
+		if (d != 0) nonZero.push_back(d);
+	std::sort(nonZero.begin(), nonZero.end(), [](double a, double b) { return std::abs(a) < std::abs(b); });
+
+	double rankSum = 0.0, tieTerm = 0.0;
+	for (size_t i = 0; i < nonZero.size();)
+	{
+		size_t j = i;
+		while (j < nonZero.size() && std::abs(nonZero[j]) == std::abs(nonZero[i]))
+			j++;
+
+		double rank = 0.5 * (double)(i + j + 1);
+		for (size_t k = i; k < j; k++)
+			if (nonZero[k] > 0) rankSum += rank;
+
+		double t = (double)(j - i);
+		tieTerm += t * t * t - t;
+		i = j;
+	}
+
+	double n = (double)nonZero.size();
+	double mean = n * (n + 1) / 4;
+	double variance = n * (n + 1) * (2 * n + 1) / 24 - tieTerm / 48;
+	if (variance <= 0)
+		return 1.0;
+
+	double z = (rankSum - mean - 0.5) / std::sqrt(variance);
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+std::vector<double> GetSamples(const JsonValue& bin)
+{
+	std::vector<double> samples;
+	for (const JsonValue& sample : bin["samples"].AsArray())
+		if (sample.IsNumber()) samples.push_back(sample.AsNumber());
+	return samples;
+}
+
+enum class Verdict { Unchanged, Regression, Improvement };
+constexpr const char* VerdictNames[] = { "", "REGRESSION", "improvement" };
+
+// Result of comparing the samples of one bin or set
+struct Comparison
+{
+	double baseMedian, candMedian, change, p;
+	Verdict verdict; // Unchanged unless significant beyond the threshold
+};
+
+std::optional<Comparison> Compare(const JsonValue& baseline, const JsonValue& candidate, double threshold, double alpha)
+{
+	std::vector<double> baseSamples = GetSamples(baseline);
+	std::vector<double> candSamples = GetSamples(candidate);
+	if (baseSamples.size() < 2 || candSamples.size() < 2)
+		return std::nullopt;
+
+	double baseMedian = Median(baseSamples), candMedian = Median(candSamples);
+	double change = candMedian / baseMedian - 1;
+	double pSlower = MannWhitneyGreater(baseSamples, candSamples);
+	double pFaster = MannWhitneyGreater(candSamples, baseSamples);
+
+	Verdict verdict = Verdict::Unchanged;
+	if (pSlower < alpha && change > threshold)
+		verdict = Verdict::Regression;
+	else if (pFaster < alpha && change < -threshold)
+		verdict = Verdict::Improvement;
+
+	return Comparison{ baseMedian, candMedian, change, std::min(pSlower, pFaster), verdict };
+}
+
+// Verdict over many bins from the logs of their candidate/baseline ratios
+struct Aggregate
+{
+	size_t count;
+	double change, p;
+	Verdict verdict;
+};
+
+Aggregate AggregateRatios(const std::vector<double>& logRatios, double threshold, double alpha)
+{
+	double sum = 0.0;
+	std::vector<double> negated;
+	for (double r : logRatios)
+	{
+		sum += r;
+		negated.push_back(-r);
+	}
+
+	double change = std::exp(sum / (double)logRatios.size()) - 1;
+	double pSlower = WilcoxonGreater(logRatios);
+	double pFaster = WilcoxonGreater(negated);
+
+	Verdict verdict = Verdict::Unchanged;
+	if (pSlower < alpha && change > threshold)
+		verdict = Verdict::Regression;
+	else if (pFaster < alpha && change < -threshold)
+		verdict = Verdict::Improvement;
+
+	return { logRatios.size(), change, std::min(pSlower, pFaster), verdict };
+}
+
+int main(int argc, char** argv)
+{
+	// compare <baseline.json> <candidate.json> [--threshold t] [--latency-threshold t] [--alpha a]
+	if (argc < 3)
+	{
+		std::cerr << "Usage: compare <baseline.json> <candidate.json> [--threshold t] [--latency-threshold t] [--alpha a]\n";
+		return 2;
+	}
+
+	double threshold = defaultThreshold, latencyThreshold = defaultLatencyThreshold, alpha = defaultAlpha;
+	for (int i = 3; i + 1 < argc; i += 2)
+	{
+		double* out = nullptr;
+		if (strcmp(argv[i], "--threshold") == 0) out = &threshold;
+		else if (strcmp(argv[i], "--latency-threshold") == 0) out = &latencyThreshold;
+		else if (strcmp(argv[i], "--alpha") == 0) out = &alpha;
+
+		if (!out || std::from_chars(argv[i + 1], argv[i + 1] + strlen(argv[i + 1]), *out).ec != std::errc())
+		{
+			std::cerr << std::format("Invalid option: {} {}\n", argv[i], argv[i + 1]);
+			return 2;
+		}
+	}
+
+	std::optional<JsonValue> baseline = ReadResults(argv[1]);
+	std::optional<JsonValue> candidate = ReadResults(argv[2]);
+	if (!baseline || !candidate)
+		return 2;
+
+	// Stats builds time the counters as much as the evaluation
+	const JsonValue& baseStats = (*baseline)["build"]["stats"];
+	const JsonValue& candStats = (*candidate)["build"]["stats"];
+	if (!baseStats.IsBool() || !candStats.IsBool())
+		std::cout << "Warning: REFERENCEW_STATS not recorded, results may not be comparable\n";
+	else if (baseStats.AsBool() != candStats.AsBool())
+	{
+		std::cerr << std::format("REFERENCEW_STATS differs ({} vs {}), rebuild both with the same setting\n", baseStats.AsBool(), candStats.AsBool());
+		return 2;
+	}
+
+	// Results from different machines or builds are still compared, but say so
+	if ((*baseline)["cpu"].AsString() != (*candidate)["cpu"].AsString())
+		std::cout << std::format("Warning: CPU differs ({} vs {})\n", (*baseline)["cpu"].AsString(), (*candidate)["cpu"].AsString());
+	if ((*baseline)["engine"].AsString() != (*candidate)["engine"].AsString())
+		std::cout << std::format("Comparing engines: {} (baseline) vs {} (candidate)\n", (*baseline)["engine"].AsString(), (*candidate)["engine"].AsString());
+	if ((*baseline)["inputs"].AsString() != (*candidate)["inputs"].AsString())
+		std::cout << std::format("Warning: inputs differ ({} vs {})\n", (*baseline)["inputs"].AsString(), (*candidate)["inputs"].AsString());
+	for (const char* key : { "compiler", "flags", "config", "type" })
+	{
+		const std::string& a = (*baseline)["build"][key].AsString();
+		const std::string& b = (*candidate)["build"][key].AsString();
+		if (a != b)
+			std::cout << std::format("Warning: build {} differs ({} vs {})\n", key, a, b);
+	}
+
+	// Match bins on (branch, min, max)
+	using Key = std::tuple<std::string, double, double>;
+	std::map<Key, const JsonValue*> baselineBins;
+	for (const JsonValue& bin : (*baseline)["bins"].AsArray())
+		baselineBins[{ bin["branch"].AsString(), bin["min"].AsNumber(), bin["max"].AsNumber() }] = &bin;
+
+	size_t compared = 0, regressions = 0, improvements = 0;
+	std::map<std::string, std::vector<double>> branchRatios;
+	std::cout << "Branch,Min,Max,Baseline (ns),Candidate (ns),Change,p,Result\n";
+	for (const JsonValue& bin : (*candidate)["bins"].AsArray())
+	{
+		Key key{ bin["branch"].AsString(), bin["min"].AsNumber(), bin["max"].AsNumber() };
+		auto it = baselineBins.find(key);
+		if (it == baselineBins.end())
+			continue;
+
+		std::optional<Comparison> c = Compare(*it->second, bin, threshold, alpha);
+		if (!c)
+			continue;
+		compared++;
+		regressions += c->verdict == Verdict::Regression;
+		improvements += c->verdict == Verdict::Improvement;
+		branchRatios[std::get<0>(key)].push_back(std::log(c->candMedian / c->baseMedian));
+
+		std::cout << std::format("{},{:.3f},{:.3f},{:.1f},{:.1f},{:+.2f}%,{:.2e},{}\n", std::get<0>(key), std::get<1>(key), std::get<2>(key),
+			c->baseMedian * 1e9, c->candMedian * 1e9, c->change * 100, c->p, VerdictNames[(int)c->verdict]);
+	}
+
+	// Match corpus sets on (name, branch), absent unless both runs used a corpus
+	std::map<std::pair<std::string, std::string>, const JsonValue*> baselineSets;
+	for (const JsonValue& set : (*baseline)["sets"].AsArray())
+		baselineSets[{ set["name"].AsString(), set["branch"].AsString() }] = &set;
+
+	bool setHeader = false;
+	for (const JsonValue& set : (*candidate)["sets"].AsArray())
+	{
+		auto it = baselineSets.find({ set["name"].AsString(), set["branch"].AsString() });
+		if (it == baselineSets.end())
+			continue;
+
+		std::optional<Comparison> c = Compare(*it->second, set, threshold, alpha);
+		if (!c)
+			continue;
+		compared++;
+		regressions += c->verdict == Verdict::Regression;
+		improvements += c->verdict == Verdict::Improvement;
+
+		if (!setHeader)
+			std::cout << "Set,Branch,Baseline (ns),Candidate (ns),Change,p,Result\n";
+		setHeader = true;
+		std::cout << std::format("{},{},{:.1f},{:.1f},{:+.2f}%,{:.2e},{}\n", set["name"].AsString(), set["branch"].AsString(),
+			c->baseMedian * 1e9, c->candMedian * 1e9, c->change * 100, c->p, VerdictNames[(int)c->verdict]);
+	}
+
+	// Per branch verdicts over all bins
+	std::cout << "Branch,Bins,Change,p,Result\n";
+	for (const auto& [branch, ratios] : branchRatios)
+	{
+		Aggregate a = AggregateRatios(ratios, threshold, alpha);
+		regressions += a.verdict == Verdict::Regression;
+		improvements += a.verdict == Verdict::Improvement;
+		std::cout << std::format("{},{},{:+.2f}%,{:.2e},{}\n", branch, a.count, a.change * 100, a.p, VerdictNames[(int)a.verdict]);
+	}
+
+	// Latency percentiles per branch, matched on (branch, min, max) like the bins
+	std::map<Key, const JsonValue*> baselineLatencies;
+	for (const JsonValue& bin : (*baseline)["latency"].AsArray())
+		baselineLatencies[{ bin["branch"].AsString(), bin["min"].AsNumber(), bin["max"].AsNumber() }] = &bin;
+
+	std::map<std::pair<std::string, std::string>, std::vector<double>> latencyRatios;
+	std::vector<std::pair<const JsonValue*, const JsonValue*>> branchLatencies;
+	for (const JsonValue& bin : (*candidate)["latency"].AsArray())
+	{
+		auto it = baselineLatencies.find({ bin["branch"].AsString(), bin["min"].AsNumber(), bin["max"].AsNumber() });
+		if (it == baselineLatencies.end())
+			continue;
+
+		// Rows over all bins of a branch are checked on their own, not as one more bin
+		bool isBranch = bin["scope"].AsString() == "branch";
+		if (isBranch != ((*it->second)["scope"].AsString() == "branch"))
+			continue;
+		if (isBranch)
+		{
+			branchLatencies.push_back({ it->second, &bin });
+			continue;
+		}
+
+		for (const char* percentile : LatencyPercentiles)
+		{
+			const JsonValue& base = (*it->second)[percentile];
+			const JsonValue& cand = bin[percentile];
+			if (base.IsNumber() && cand.IsNumber() && base.AsNumber() > 0 && cand.AsNumber() > 0)
+				latencyRatios[{ bin["branch"].AsString(), percentile }].push_back(std::log(cand.AsNumber() / base.AsNumber()));
+		}
+	}
+
+	if (!latencyRatios.empty())
+		std::cout << "Branch,Percentile,Bins,Change,p,Result\n";
+	for (const auto& [key, ratios] : latencyRatios)
+	{
+		Aggregate a = AggregateRatios(ratios, latencyThreshold, alpha);
+		regressions += a.verdict == Verdict::Regression;
+		improvements += a.verdict == Verdict::Improvement;
+		std::cout << std::format("{},{},{},{:+.2f}%,{:.2e},{}\n", key.first, key.second, a.count, a.change * 100, a.p, VerdictNames[(int)a.verdict]);
+	}
+
+	// Percentiles of the merged histograms, single values so only the threshold applies
+	if (!branchLatencies.empty())
+		std::cout << "Branch,Percentile,Baseline (ns),Candidate (ns),Change,Result\n";
+	for (const auto& [base, cand] : branchLatencies)
+	{
+		for (const char* percentile : LatencyPercentiles)
+		{
+			double b = (*base)[percentile].AsNumber(), c = (*cand)[percentile].AsNumber();
+			if (!(*base)[percentile].IsNumber() || !(*cand)[percentile].IsNumber() || b <= 0 || c <= 0)
+				continue;
+			double change = c / b - 1;
+			Verdict verdict = Verdict::Unchanged;
+			if (change > latencyThreshold) verdict = Verdict::Regression;
+			else if (change < -latencyThreshold) verdict = Verdict::Improvement;
+			regressions += verdict == Verdict::Regression;
+			improvements += verdict == Verdict::Improvement;
+			std::cout << std::format("{},{},{:.1f},{:.1f},{:+.2f}%,{}\n", (*cand)["branch"].AsString(), percentile, b, c, change * 100, VerdictNames[(int)verdict]);
+		}
+	}
+
+	std::cout << std::format("{} bins and sets compared, {} regressions, {} improvements including aggregates (threshold {:.1f}%, latency {:.1f}%, alpha {})\n",
+		compared, regressions, improvements, threshold * 100, latencyThreshold * 100, alpha);
+	if (compared == 0)
+	{
+		std::cerr << "No matching bins\n";
+		return 2;
+	}
+
+	return regressions ? 1 : 0;
+}
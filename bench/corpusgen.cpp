@@ -0,0 +1,102 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <format>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+
+#include "ExpMap.h"
+#include "Corpus.h"
+#include "../tests/ReciprocalDistributionEx.h"
+
+/*
+Generates the benchmark corpus, for both types and branches:
+	expmap		the exp-mapped bins benchmarked by bench, min and max are the uniform variable
+	reciprocal	the reciprocal distributions over each branch's domain used by the tests
+	nearbranch	EM_UP + exp(t) for uniform t, inputs whose distance to -1/e spans the whole exponent range
+bench times the exp-mapped bins one by one and the other two as whole sets.
+*/
+
+// === Parameters ===
+constexpr double binMin = -35.5;
+constexpr double binMax = 10;
+constexpr double binWidth = 0.5;
+constexpr size_t pointsPerBin = 10'000;
+constexpr size_t pointsPerSet = 1'000'000;
+// ==================
+
+template <typename Ty>
+void AddSections(CorpusWriter& writer, int64_t branch, std::mt19937_64& gen)
+{
+	static constexpr Ty EM_UP = std::is_same_v<Ty, float> ? (Ty)-0.36787942f : (Ty)-0.3678794411714423;
+
+	// Exp-mapped bins
+	for (Ty min = (Ty)binMin; min < (Ty)binMax; min += (Ty)binWidth)
+	{
+		Ty max = min + (Ty)binWidth;
+		std::uniform_real_distribution<Ty> dist{ min, max };
+
+		std::vector<Ty> data;
+		data.reserve(pointsPerBin);
+		for (size_t i = 0; i < pointsPerBin; i++)
+			data.push_back((branch == 0) ? ExpMapW0(dist(gen)) : ExpMapWm1(dist(gen)));
+		writer.AddSection("expmap", branch, min, max, data);
+	}
+
+	// Reciprocal distribution over the domain
+	{
+		Ty max = (branch == 0) ? (Ty)INFINITY : (Ty)0;
+		ReciprocalDistributionEx<Ty> dist{ EM_UP, max, false };
+
+		std::vector<Ty> data;
+		data.reserve(pointsPerSet);
+		for (size_t i = 0; i < pointsPerSet; i++)
+			data.push_back(dist(gen));
+		writer.AddSection("reciprocal", branch, EM_UP, max, data);
+	}
+
+	// Near the branch point
+	{
+		Ty min = std::is_same_v<Ty, float> ? (Ty)-18.021828 : (Ty)-38.123094930796995;
+		std::uniform_real_distribution<Ty> dist{ min, (Ty)-1 };
+
+		std::vector<Ty> data;
+		data.reserve(pointsPerSet);
+		for (size_t i = 0; i < pointsPerSet; i++)
+			data.push_back(EM_UP + std::exp(dist(gen)));
+		writer.AddSection("nearbranch", branch, min, -1, data);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// corpusgen [output] [seed]
+	std::string path = (argc > 1) ? argv[1] : "corpus.bin";
+	uint64_t seed = 0;
+	if (argc > 2)
+	{
+		const char* end = argv[2] + strlen(argv[2]);
+		auto [ptr, ec] = std::from_chars(argv[2], end, seed);
+		if (ec != std::errc() || ptr != end)
+		{
+			std::cerr << std::format("Invalid seed: {}\n", argv[2]);
+			return 1;
+		}
+	}
+
+	std::mt19937_64 gen{ seed };
+	CorpusWriter writer;
+	for (int64_t branch : { 0, -1 })
+	{
+		AddSections<float>(writer, branch, gen);
+		AddSections<double>(writer, branch, gen);
+	}
+
+	if (!writer.Write(path))
+	{
+		std::cerr << std::format("Failed to write {}\n", path);
+		return 1;
+	}
+	std::cout << std::format("Corpus written to {}\n", path);
+}
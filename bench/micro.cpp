@@ -0,0 +1,419 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <array>
+#include <random>
+#include <format>
+#include <cmath>
+#include <cfenv>
+#include <algorithm>
+
+#define SLEEF_STATIC_LIBS
+#include <sleef.h>
+
+#include <arb.h>
+
+#include <ReferenceLambertW.h>
+#include "../src/rndutil.h"
+#include "../src/approx.h"
+#include "../src/arbutil.h"
+
+#include "CycleTimer.h"
+
+/*
+Primitive cost microbenchmark and cost model for ReferenceW
+
+Each building block of W0Bracket, Wm1Bracket and GetMidpointResidual is timed on the arguments it sees
+in each region of the input, where a region is a run of inputs which take the same code path. The
+number of calls per evaluation comes from mirroring the bracket code paths for the bracket, and from
+the bisection stats for the sign tests, split between a full arb_exp and the Taylor series from the
+exp anchor by the reuse stats. Their product is a modelled cost per evaluation, which is
+printed next to the measured cost so the model can be trusted only as far as it agrees.
+	micro.csv		Region, primitive, ns per call
+	model.csv		Region, part, primitive, calls per evaluation, ns per evaluation, share
+	summary.csv		Region, modelled and measured ns per evaluation, sign tests per evaluation
+*/
+
+// === Parameters ===
+constexpr size_t Num = 4'096;		// Arguments per measurement
+constexpr size_t Repeats = 7;		// Best of
+constexpr size_t StatsNum = 20'000;	// Evaluations per region for the call counts
+// ==================
+
+static constexpr double EM_UP = -0.3678794411714423;
+
+enum Primitive
+{
+	FeSetRound,
+	RndOp,
+	RndSqrt,
+	RndFma,
+	SleefExp,
+	SleefLog,
+	SleefLog1p,
+	StdLog,
+	Approx,
+	ArbSetD,
+	ArbExp90,
+	ArbExpReuse90,
+	ArbExp100,
+	ArbExp150,
+	ArbMulSub90,
+	ArbMulSub100,
+	ArbMulSub150,
+	ArbDiv100,
+	ArbBound,
+	NumPrimitives
+};
+
+static constexpr const char* PrimitiveNames[NumPrimitives] = {
+	"fesetround", "rndutil add/sub/mul/div", "rndutil sqrt", "rndutil fma", "Sleef_exp_u10", "Sleef_log_u10", "Sleef_log1p_u10",
+	"log", "Initial approximation", "arb_set_d", "arb_exp 90", "exp from anchor 90", "arb_exp 100", "arb_exp 150",
+	"arb_mul+arb_sub 90", "arb_mul+arb_sub 100", "arb_mul+arb_sub 150", "arb_div 100", "arb_abs+arb_get_ubound_arf+arf_get_d"
+};
+
+using Counts = std::array<double, NumPrimitives>;
+
+struct Region
+{
+	const char* name;
+	int64_t branch;
+	double (*sample)(std::mt19937_64& gen);
+};
+
+static double Uniform(std::mt19937_64& gen, double min, double max)
+{
+	return std::uniform_real_distribution<double>{ min, max }(gen);
+}
+
+// Regions split where the bracket changes code path
+static const Region Regions[] = {
+	{ "W0 near branch", 0, [](std::mt19937_64& gen) { return EM_UP + std::exp(Uniform(gen, -36, std::log(-0.28 - EM_UP))); } },
+	{ "W0 arb del", 0, [](std::mt19937_64& gen) { return Uniform(gen, -0.28, 4.11380962917); } },
+	{ "W0 first approx", 0, [](std::mt19937_64& gen) { return Uniform(gen, 4.11380962917, 7.34); } },
+	{ "W0 second approx", 0, [](std::mt19937_64& gen) { return std::exp(Uniform(gen, std::log(7.34), 709)); } },
+	{ "Wm1 near branch", -1, [](std::mt19937_64& gen) { return EM_UP + std::exp(Uniform(gen, -36, std::log(-0.318092372804 - EM_UP))); } },
+	{ "Wm1 arb del", -1, [](std::mt19937_64& gen) { return -std::exp(Uniform(gen, std::log(0.00000137095397731), std::log(0.318092372804))); } },
+	{ "Wm1 sleef del", -1, [](std::mt19937_64& gen) { return -std::exp(Uniform(gen, -744, std::log(0.00000137095397731))); } },
+};
+
+static double InitialApprox(int64_t branch, double x)
+{
+	if (branch == 0)
+		return (x < -0.28) ? NearBranchW0(x) : ((x < 7.34) ? FirstApproxW0(x) : SecondApproxW0(x));
+	return (x < -0.318092372804) ? NearBranchWm1(x) : GeneralWm1(x);
+}
+
+// Primitive calls made by one call of W0Bracket or Wm1Bracket, mirroring their code paths
+static Counts BracketCounts(int64_t branch, double x)
+{
+	Counts c{};
+	c[FeSetRound] += 1;
+	c[Approx] += 1;
+
+	if (branch == 0)
+	{
+		// Fritsch iteration
+		if (x >= -0.28)
+			c[StdLog] += 1;
+
+		// Derivative bound
+		if (x > 0.01)
+		{
+			c[SleefLog1p] += 1;
+			c[RndOp] += 3;
+		}
+		else if (x < -0.01)
+		{
+			c[RndFma] += 3;
+			c[RndSqrt] += 1;
+			c[RndOp] += 3;
+		}
+		else if (x < 0)
+			c[RndOp] += 3;
+
+		// Del bound
+		if (x > 4.11380962917)
+		{
+			c[SleefExp] += 1;
+			c[FeSetRound] += 1;
+			c[RndOp] += 4;
+		}
+		else
+		{
+			c[ArbSetD] += 2;
+			c[ArbExp100] += 1;
+			c[ArbMulSub100] += 1;
+			c[ArbDiv100] += 1;
+			c[ArbBound] += 1;
+		}
+	}
+	else
+	{
+		// Fritsch iteration
+		if (x >= -0.318092372804)
+			c[StdLog] += 1;
+
+		// Derivative bound
+		c[SleefLog] += 1;
+		c[RndSqrt] += 1;
+		c[RndOp] += 7;
+
+		// Del bound
+		if (x > -0.00000137095397731)
+		{
+			c[RndOp] += 10;
+			c[FeSetRound] += 1;
+			c[SleefExp] += 2;
+		}
+		else
+		{
+			c[ArbSetD] += 2;
+			c[ArbExp100] += 1;
+			c[ArbMulSub100] += 1;
+			c[ArbDiv100] += 1;
+			c[ArbBound] += 1;
+		}
+	}
+
+	// Final error
+	c[RndOp] += 3;
+
+	return c;
+}
+
+// One call of GetMidpointResidual, where reuseRate of the 90 bit ones reuse the exp anchor
+static Counts SignTestCounts(bool useHighPrec, double reuseRate)
+{
+	Counts c{};
+	c[ArbSetD] += 2;
+	if (useHighPrec)
+	{
+		c[ArbExp150] += 1;
+		c[ArbMulSub150] += 1;
+	}
+	else
+	{
+		c[ArbExp90] += 1 - reuseRate;
+		c[ArbExpReuse90] += reuseRate;
+		c[ArbMulSub90] += 1;
+	}
+	return c;
+}
+
+static volatile double sink;
+
+// Best of Repeats, in ns per call
+template <typename F>
+double Measure(size_t num, F f)
+{
+	uint64_t best = UINT64_MAX;
+	double acc = 0;
+	for (size_t r = 0; r < Repeats; r++)
+	{
+		uint64_t start = CycleTimer::Now();
+		for (size_t i = 0; i < num; i++)
+			acc += f(i);
+		uint64_t end = CycleTimer::Now();
+		best = std::min(best, end - start);
+	}
+	sink = acc;
+	fesetround(FE_TONEAREST);
+
+	return (double)best * CycleTimer::SecondsPerTick() * 1e9 / (double)num;
+}
+
+// arb arguments for one region, initialized once
+class ArbArgs
+{
+public:
+	// Anchors sit a reuse distance from w, log uniform in relative size from a few ulps to 2^-17
+	ArbArgs(const std::vector<double>& xs, const std::vector<double>& ws, std::mt19937_64& gen)
+		: x(xs.size()), w(xs.size()), expW(xs.size()), anchor(xs.size()), expAnchor(xs.size())
+	{
+		for (size_t i = 0; i < xs.size(); i++)
+		{
+			arb_init(&x[i]);
+			arb_init(&w[i]);
+			arb_init(&expW[i]);
+			arb_init(&anchor[i]);
+			arb_init(&expAnchor[i]);
+			arb_set_d(&x[i], xs[i]);
+			arb_set_d(&w[i], ws[i]);
+			arb_exp(&expW[i], &w[i], 150);
+
+			double d = std::ldexp(std::max(std::abs(ws[i]), 1.0), -(int)Uniform(gen, 17, 50));
+			arb_set_d(&anchor[i], ws[i] + d);
+			arb_exp(&expAnchor[i], &anchor[i], 90);
+		}
+	}
+
+	~ArbArgs()
+	{
+		for (size_t i = 0; i < x.size(); i++)
+		{
+			arb_clear(&x[i]);
+			arb_clear(&w[i]);
+			arb_clear(&expW[i]);
+			arb_clear(&anchor[i]);
+			arb_clear(&expAnchor[i]);
+		}
+	}
+
+	ArbArgs(const ArbArgs&) = delete;
+	ArbArgs& operator=(const ArbArgs&) = delete;
+
+	std::vector<arb_struct> x, w, expW, anchor, expAnchor;
+};
+
+static Counts MeasurePrimitives(const Region& region, const std::vector<double>& xs, const std::vector<double>& ws, std::mt19937_64& gen)
+{
+	Counts ns{};
+	size_t n = xs.size();
+	bool isTiny = region.branch == -1 && xs[0] > -0.00000137095397731;
+
+	ns[FeSetRound] = Measure(n, [&](size_t i) { fesetround((i % 2) ? FE_UPWARD : FE_DOWNWARD); return 0.0; });
+	ns[RndOp] = 0.25 * (
+		Measure(n, [&](size_t i) { return add(ws[i], xs[i], FE_UPWARD); }) +
+		Measure(n, [&](size_t i) { return sub(ws[i], xs[i], FE_DOWNWARD); }) +
+		Measure(n, [&](size_t i) { return mul(ws[i], xs[i], FE_UPWARD); }) +
+		Measure(n, [&](size_t i) { return div(ws[i], xs[i], FE_DOWNWARD); }));
+	ns[RndSqrt] = Measure(n, [&](size_t i) { return sqrt(std::abs(xs[i]), FE_DOWNWARD); });
+	ns[RndFma] = Measure(n, [&](size_t i) { return (double)fma(ws[i], xs[i], 2.0, FE_UPWARD); });
+	ns[SleefExp] = Measure(n, [&](size_t i) { return Sleef_exp_u10(isTiny ? ws[i] + 50 : ws[i]); });
+	ns[SleefLog] = Measure(n, [&](size_t i) { return Sleef_log_u10(std::abs(xs[i])); });
+	ns[SleefLog1p] = Measure(n, [&](size_t i) { return Sleef_log1p_u10(std::abs(xs[i])); });
+	ns[StdLog] = Measure(n, [&](size_t i) { return std::log(xs[i] / ws[i]); });
+	ns[Approx] = Measure(n, [&](size_t i) { return InitialApprox(region.branch, xs[i]); });
+
+	ArbArgs args{ xs, ws, gen };
+	arb_t y, d, series;
+	arb_init(y);
+	arb_init(d);
+	arb_init(series);
+	mag_t err;
+	mag_init(err);
+	arf_t bound;
+	arf_init(bound);
+
+	ns[ArbSetD] = Measure(n, [&](size_t i) { arb_set_d(y, ws[i]); return 0.0; });
+	for (auto [prim, prec] : { std::pair{ ArbExp90, 90 }, { ArbExp100, 100 }, { ArbExp150, 150 } })
+		ns[prim] = Measure(n, [&](size_t i) { arb_exp(y, &args.w[i], prec); return 0.0; });
+
+	// As in ReferenceW's Exp, the distance check and the series
+	ns[ArbExpReuse90] = Measure(n, [&](size_t i)
+	{
+		arb_sub(d, &args.w[i], &args.anchor[i], 90);
+		arb_get_mag(err, d);
+		ExpShifted(y, &args.expAnchor[i], d, -16, 90, series, err);
+		return (double)mag_cmp_2exp_si(err, 0);
+	});
+	for (auto [prim, prec] : { std::pair{ ArbMulSub90, 90 }, { ArbMulSub100, 100 }, { ArbMulSub150, 150 } })
+	{
+		ns[prim] = Measure(n, [&](size_t i)
+		{
+			arb_mul(y, &args.expW[i], &args.w[i], prec);
+			arb_sub(y, y, &args.x[i], prec);
+			return 0.0;
+		});
+	}
+	ns[ArbDiv100] = Measure(n, [&](size_t i) { arb_div(y, &args.expW[i], &args.x[i], 100); return 0.0; });
+	ns[ArbBound] = Measure(n, [&](size_t i)
+	{
+		arb_abs(y, &args.expW[i]);
+		arb_get_ubound_arf(bound, y, 100);
+		return arf_get_d(bound, ARF_RND_UP);
+	});
+
+	arf_clear(bound);
+	mag_clear(err);
+	arb_clear(series);
+	arb_clear(d);
+	arb_clear(y);
+	return ns;
+}
+
+int main()
+{
+	std::mt19937_64 gen{ 0 };
+	std::ofstream microFile{ "micro.csv" }, modelFile{ "model.csv" }, summaryFile{ "summary.csv" };
+	microFile << "Region,Primitive,ns\n";
+	modelFile << "Region,Part,Primitive,Calls,ns,Share\n";
+	summaryFile << "Region,Modelled (ns),Measured (ns),Sign Tests,HighPrec Sign Tests,Exp Reuse Rate\n";
+
+#if !REFERENCEW_STATS
+	std::cout << "REFERENCEW_STATS is disabled, sign tests are not counted and the model only covers the bracket\n";
+#endif
+
+	for (const Region& region : Regions)
+	{
+		std::cout << region.name << '\n';
+
+		std::vector<double> xs, ws;
+		for (size_t i = 0; i < Num; i++)
+		{
+			double x = region.sample(gen);
+			xs.push_back(x);
+			ws.push_back(InitialApprox(region.branch, x));
+		}
+
+		Counts ns = MeasurePrimitives(region, xs, ws, gen);
+		for (size_t p = 0; p < NumPrimitives; p++)
+			microFile << std::format("{},{},{:.2f}\n", region.name, PrimitiveNames[p], ns[p]);
+
+		// Calls per evaluation
+		Counts bracket{}, lowPrec{}, highPrec{};
+		for (double x : xs)
+		{
+			Counts c = BracketCounts(region.branch, x);
+			for (size_t p = 0; p < NumPrimitives; p++)
+				bracket[p] += c[p] / (double)xs.size();
+		}
+		bracket[FeSetRound] += 2; // Bisection and restoring the caller's mode
+
+		ReferenceW evaluator;
+		double signTests = 0, highPrecTests = 0, reuseRate = 0;
+#if REFERENCEW_STATS
+		size_t totalBisections = evaluator.GetTotalBisections(), numHighPrec = evaluator.GetNumHighPrec();
+		size_t numExpReuse = evaluator.GetNumExpReuse();
+		for (size_t i = 0; i < StatsNum; i++)
+		{
+			double x = region.sample(gen);
+			(region.branch == 0) ? evaluator.W0(x) : evaluator.Wm1(x);
+		}
+
+		// Every bisection but the last of each evaluation tests a midpoint
+		signTests = (double)(evaluator.GetTotalBisections() - totalBisections - StatsNum) / StatsNum;
+		highPrecTests = (double)(evaluator.GetNumHighPrec() - numHighPrec) / StatsNum;
+		if (signTests > 0)
+			reuseRate = (double)(evaluator.GetNumExpReuse() - numExpReuse) / StatsNum / signTests;
+#endif
+		Counts lowSign = SignTestCounts(false, reuseRate), highSign = SignTestCounts(true, 0);
+		for (size_t p = 0; p < NumPrimitives; p++)
+		{
+			lowPrec[p] = lowSign[p] * signTests;
+			highPrec[p] = highSign[p] * highPrecTests;
+		}
+
+		double measured = Measure(xs.size(), [&](size_t i) { return ((region.branch == 0) ? evaluator.W0(xs[i]) : evaluator.Wm1(xs[i])).inf; });
+
+		double modelled = 0;
+		for (const Counts* part : { &bracket, &lowPrec, &highPrec })
+			for (size_t p = 0; p < NumPrimitives; p++)
+				modelled += (*part)[p] * ns[p];
+
+		const std::pair<const char*, const Counts*> parts[] = { { "Bracket", &bracket }, { "Sign tests 90", &lowPrec }, { "Sign tests 150", &highPrec } };
+		for (auto [partName, part] : parts)
+		{
+			for (size_t p = 0; p < NumPrimitives; p++)
+			{
+				if ((*part)[p] == 0)
+					continue;
+				double cost = (*part)[p] * ns[p];
+				modelFile << std::format("{},{},{},{:.3f},{:.2f},{:.4f}\n", region.name, partName, PrimitiveNames[p], (*part)[p], cost, cost / modelled);
+			}
+		}
+
+		summaryFile << std::format("{},{:.1f},{:.1f},{:.3f},{:.4f},{:.4f}\n", region.name, modelled, measured, signTests, highPrecTests, reuseRate);
+	}
+}
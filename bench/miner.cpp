@@ -0,0 +1,211 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <format>
+#include <charconv>
+#include <cstring>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include <ReferenceLambertW.h>
+
+#define TIMER_NPRINT
+#include "Timer.h"
+#include "ExpMap.h"
+#include "../src/Ordered.h"
+
+/*
+Worst-case latency miner
+
+Simulated annealing over the bits of the input. A state is the ordered integer of x, and moves
+either flip a random bit or take a small step in ulps, so the search can both jump between regions
+and walk along a run of slow neighbours. Each input is scored on its wall time (best of a few
+repeats, to reject scheduling noise), with bisections and high precision fallbacks as
+tie-breakers. The slowest unique inputs seen over all restarts form the output corpus.
+*/
+
+// === Parameters ===
+constexpr size_t restarts = 32;
+constexpr size_t stepsPerRestart = 2'000;
+constexpr size_t repeats = 3;
+constexpr size_t corpusSize = 256;
+constexpr double initialTemp = 0.5;	// Relative score decrease accepted with probability 1/e
+constexpr double finalTemp = 0.005;
+// ==================
+
+template <typename Ty>
+struct Sample
+{
+	Ty x;
+	double seconds;
+	size_t bisections, highPrec;
+
+	double Score() const
+	{
+		return seconds * (1.0 + 1e-3 * (double)highPrec + 1e-6 * (double)bisections);
+	}
+};
+
+template <typename Ty>
+class LatencyMiner
+{
+public:
+	using Bits = OrderedInt<Ty>;
+
+	LatencyMiner(int64_t branch_)
+		: branch(branch_), gen(std::random_device{}()) {}
+
+	void Run()
+	{
+		for (size_t r = 0; r < restarts; r++)
+			Anneal(Seed());
+	}
+
+	std::vector<Sample<Ty>> GetCorpus() const
+	{
+		std::vector<Sample<Ty>> corpus;
+		for (const auto& [_, sample] : seen)
+			corpus.push_back(sample);
+
+		std::sort(corpus.begin(), corpus.end(), [](const Sample<Ty>& a, const Sample<Ty>& b) { return a.Score() > b.Score(); });
+		if (corpus.size() > corpusSize)
+			corpus.resize(corpusSize);
+
+		return corpus;
+	}
+
+protected:
+	int64_t branch;
+	std::mt19937_64 gen;
+	BasicReferenceW<Ty> evaluator;
+	std::unordered_map<Bits, Sample<Ty>> seen;
+
+	bool InDomain(Ty x) const
+	{
+		static constexpr Ty EM_UP = std::is_same_v<Ty, float> ? (Ty)-0.36787942f : (Ty)-0.3678794411714423;
+
+		if (!std::isfinite(x) || x < EM_UP)
+			return false;
+		return (branch == 0) || (x < 0);
+	}
+
+	// Uniform sample of the same bins the benchmark covers
+	Ty Seed()
+	{
+		std::uniform_real_distribution<Ty> dist{ (Ty)-35.5, (Ty)10 };
+		for (;;)
+		{
+			Ty x = (branch == 0) ? ExpMapW0(dist(gen)) : ExpMapWm1(dist(gen));
+			if (InDomain(x))
+				return x;
+		}
+	}
+
+	Sample<Ty> Measure(Ty x)
+	{
+		auto it = seen.find(ToOrdered(x));
+		if (it != seen.end())
+			return it->second;
+
+		Sample<Ty> sample{ x, INFINITY, 0, 0 };
+		for (size_t i = 0; i < repeats; i++)
+		{
+#if REFERENCEW_STATS
+			size_t bisections = evaluator.GetTotalBisections();
+			size_t highPrec = evaluator.GetNumHighPrec();
+#endif
+
+			// Each repeat is timed cold, as the exp anchor of the previous one is an exact match
+			evaluator.ResetExpAnchor();
+			Timer t;
+			if (branch == 0)
+				evaluator.W0(x);
+			else
+				evaluator.Wm1(x);
+			t.Stop();
+
+			sample.seconds = std::min(sample.seconds, t.GetSeconds());
+#if REFERENCEW_STATS
+			sample.bisections = evaluator.GetTotalBisections() - bisections;
+			sample.highPrec = evaluator.GetNumHighPrec() - highPrec;
+#endif
+		}
+
+		seen.emplace(ToOrdered(x), sample);
+		return sample;
+	}
+
+	Ty Mutate(Ty x)
+	{
+		static constexpr int numBits = sizeof(Ty) * 8;
+
+		for (;;)
+		{
+			Bits o = ToOrdered(x);
+			if (gen() % 2)
+			{
+				// Bit flip, the sign is fixed by the domain
+				int bit = (int)(gen() % (numBits - 1));
+				o ^= (Bits)1 << bit;
+			}
+			else
+			{
+				// Small step in ulps
+				int64_t step = (int64_t)(gen() % 64) - 32;
+				o += (Bits)step;
+			}
+
+			Ty y = FromOrdered<Ty>(o);
+			if (InDomain(y))
+				return y;
+		}
+	}
+
+	void Anneal(Ty x)
+	{
+		std::uniform_real_distribution<double> unit{ 0, 1 };
+
+		Sample<Ty> current = Measure(x);
+		for (size_t i = 0; i < stepsPerRestart; i++)
+		{
+			double temp = initialTemp * std::pow(finalTemp / initialTemp, (double)i / stepsPerRestart);
+
+			Sample<Ty> candidate = Measure(Mutate(current.x));
+			double delta = (candidate.Score() - current.Score()) / current.Score();
+			if (delta > 0 || unit(gen) < std::exp(delta / temp))
+				current = candidate;
+		}
+	}
+};
+
+template <typename Ty>
+void Mine(int64_t branch, const std::string& path)
+{
+	LatencyMiner<Ty> miner{ branch };
+	miner.Run();
+
+	std::ofstream file{ path };
+	file << "x,Seconds,Bisections,HighPrec\n";
+	for (const Sample<Ty>& sample : miner.GetCorpus())
+		file << std::format("{:a},{:.10e},{},{}\n", sample.x, sample.seconds, sample.bisections, sample.highPrec);
+}
+
+int main(int argc, char** argv)
+{
+	// miner [float|double] [branch]
+	std::string type = (argc > 1) ? argv[1] : "double";
+	int64_t branch = 0;
+	if (argc > 2) std::from_chars(argv[2], argv[2] + strlen(argv[2]), branch);
+
+	std::string path = std::format("worst_{}_{}.csv", type, (branch == 0) ? "W0" : "Wm1");
+	if (type == "float")
+		Mine<float>(branch, path);
+	else
+		Mine<double>(branch, path);
+
+	std::cout << std::format("Corpus written to {}\n", path);
+}
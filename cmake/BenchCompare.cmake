@@ -0,0 +1,85 @@
+# SCRIPT - Benchmark a baseline commit against the working tree
+#
+#	cmake -DBASELINE=<commit> [-DWORK_DIR=<dir>] -P cmake/BenchCompare.cmake
+#
+# Builds the working tree warning-clean and runs its full ctest suite, then builds the baseline in a
+# git worktree and runs bench and compare for BenchTy double and float. Baselines without the
+# REFERENCEW_BENCH_FLOAT option get BenchTy switched to float in their bench.cpp. The compare
+# verdicts are left in <WORK_DIR>/compare-double.txt and compare-float.txt.
+
+cmake_minimum_required(VERSION 3.21)
+
+if (NOT BASELINE)
+    message(FATAL_ERROR "Usage: cmake -DBASELINE=<commit> [-DWORK_DIR=<dir>] -P cmake/BenchCompare.cmake")
+endif()
+
+get_filename_component(sourceDir "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+if (NOT WORK_DIR)
+    set(WORK_DIR "${sourceDir}/_bench_compare")
+endif()
+get_filename_component(WORK_DIR "${WORK_DIR}" ABSOLUTE)
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+# Runs a command and stops the script if it fails
+function(run)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        string(REPLACE ";" " " command "${ARGN}")
+        message(FATAL_ERROR "Failed (${result}): ${command}")
+    endif()
+endfunction()
+
+# Configures and builds a release tree, extra arguments are passed to the configure step
+function(build source binary)
+    run(${CMAKE_COMMAND} -S "${source}" -B "${binary}" -DCMAKE_BUILD_TYPE=Release ${ARGN})
+    run(${CMAKE_COMMAND} --build "${binary}" --config Release --parallel)
+endfunction()
+
+# === Baseline Worktree ===
+set(baselineDir "${WORK_DIR}/baseline-src")
+if (NOT EXISTS "${baselineDir}")
+    run(git -C "${sourceDir}" worktree add --detach "${baselineDir}" "${BASELINE}")
+endif()
+
+# === Candidate Gates ===
+# Warnings as errors, then the full suite
+build("${sourceDir}" "${WORK_DIR}/candidate-double" -DWARNINGS=ON -DCMAKE_COMPILE_WARNING_AS_ERROR=ON)
+run(${CMAKE_CTEST_COMMAND} --test-dir "${WORK_DIR}/candidate-double" -C Release --output-on-failure)
+
+# === Bench and Compare ===
+file(READ "${baselineDir}/bench/bench.cpp" baselineBench)
+string(FIND "${baselineBench}" "REFERENCEW_BENCH_FLOAT" hasFloatOption)
+
+foreach (type IN ITEMS double float)
+    set(floatOption -DREFERENCEW_BENCH_FLOAT=OFF)
+    if (type STREQUAL "float")
+        set(floatOption -DREFERENCEW_BENCH_FLOAT=ON)
+    endif()
+
+    # The baseline's bench.cpp is rewritten for each type when it has no option for it
+    if (hasFloatOption EQUAL -1)
+        string(REPLACE "using BenchTy = double;" "using BenchTy = ${type};" typedBench "${baselineBench}")
+        file(WRITE "${baselineDir}/bench/bench.cpp" "${typedBench}")
+    endif()
+
+    build("${baselineDir}" "${WORK_DIR}/baseline-${type}" ${floatOption})
+    if (NOT type STREQUAL "double")
+        build("${sourceDir}" "${WORK_DIR}/candidate-${type}" ${floatOption})
+    endif()
+
+    foreach (side IN ITEMS baseline candidate)
+        run("${WORK_DIR}/${side}-${type}/bench/bench" "${WORK_DIR}/${side}-${type}.json"
+            WORKING_DIRECTORY "${WORK_DIR}/${side}-${type}/bench")
+    endforeach()
+
+    # compare exits non-zero on regressions, which is a result rather than a failure of the script
+    execute_process(
+        COMMAND "${WORK_DIR}/candidate-${type}/bench/compare" "${WORK_DIR}/baseline-${type}.json" "${WORK_DIR}/candidate-${type}.json"
+        OUTPUT_FILE "${WORK_DIR}/compare-${type}.txt"
+        RESULT_VARIABLE compareResult)
+    message(STATUS "compare ${type}: exit ${compareResult}, verdicts in ${WORK_DIR}/compare-${type}.txt")
+endforeach()
+
+if (hasFloatOption EQUAL -1)
+    file(WRITE "${baselineDir}/bench/bench.cpp" "${baselineBench}")
+endif()
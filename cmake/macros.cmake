@@ -10,12 +10,20 @@ macro(enable_ipo project)
     endif()
 endmacro()
 
+# Targets the build machine only with REFERENCEW_NATIVE_ARCH, otherwise the binary stays portable and
+# the hot paths are dispatched at load time (see REFERENCEW_MULTIVERSION)
 macro(set_arch project)
-    message(STATUS "Enabled extended architecture for project ${project}")
-    if (CMAKE_CXX_COMPILER_ID STREQUAL "Clang")
-        target_compile_options(${project} PUBLIC -march=native)
-    elseif (CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")
-        target_compile_options(${project} PUBLIC /arch:AVX2)
+    if (REFERENCEW_NATIVE_ARCH)
+        message(STATUS "Enabled native architecture for project ${project}")
+        if (CMAKE_CXX_COMPILER_ID MATCHES "Clang|GNU")
+            target_compile_options(${project} PUBLIC -march=native)
+        elseif (CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")
+            target_compile_options(${project} PUBLIC /arch:AVX2)
+        endif()
+        target_compile_definitions(${project} PRIVATE REFERENCEW_MULTIVERSION=0)
+    elseif (REFERENCEW_MULTIVERSION)
+        message(STATUS "Enabled runtime ISA dispatch for project ${project}")
+        target_compile_definitions(${project} PRIVATE REFERENCEW_MULTIVERSION=1)
     endif()
 endmacro()
 
@@ -23,6 +31,9 @@ macro(enable_strict_math project)
     message(STATUS "Enabled strict math for project ${project}")
     if (CMAKE_CXX_COMPILER_ID STREQUAL "Clang")
         target_compile_options(${project} PUBLIC -ffp-model=strict)
+    elseif (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+        # Contraction into FMA would merge operations rounded in different directions
+        target_compile_options(${project} PUBLIC -frounding-math -ffp-contract=off)
     elseif (CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")
         target_compile_options(${project} PUBLIC /fp:strict)
     endif()
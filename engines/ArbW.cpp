@@ -0,0 +1,89 @@
+#include "../include/config.h"
+#include "ArbW.h"
+
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+#include <iostream>
+#include <format>
+#include <exception>
+
+#include <arb.h>
+
+#include "../src/arbutil.h"
+#include "../src/ReferenceWTraits.h"
+
+// === Parameters ===
+static constexpr slong MaxPrec = 1 << 16;
+// ==================
+
+ArbW::ArbW()
+{
+	arb_init(xArb);
+	arb_init(wArb);
+	arf_init(boundArf);
+}
+
+ArbW::~ArbW()
+{
+	arb_clear(xArb);
+	arb_clear(wArb);
+	arf_clear(boundArf);
+}
+
+Interval ArbW::W0(double x)
+{
+	return Evaluate<double, Interval>(x, 0);
+}
+
+Interval ArbW::Wm1(double x)
+{
+	return Evaluate<double, Interval>(x, 1);
+}
+
+Intervalf ArbW::W0(float x)
+{
+	return Evaluate<float, Intervalf>(x, 0);
+}
+
+Intervalf ArbW::Wm1(float x)
+{
+	return Evaluate<float, Intervalf>(x, 1);
+}
+
+template <typename Ty, typename IntervalTy>
+IntervalTy ArbW::Evaluate(Ty x, int flags)
+{
+	// Edge cases, as ReferenceW
+	if (x < ReferenceWTraits<Ty>::EmUp)
+		return { NAN, NAN };
+	if (flags == 0)
+	{
+		if (x == INFINITY)
+			return { std::numeric_limits<Ty>::max(), INFINITY };
+		if (x == 0)
+			return { 0, 0 };
+	}
+	else if (x >= 0)
+		return { NAN, NAN };
+
+	arb_set_d(xArb, x);
+	for (slong prec = std::numeric_limits<Ty>::digits + 16; prec <= MaxPrec; prec *= 2)
+	{
+		arb_lambertw(wArb, xArb, flags, prec);
+		if (!arb_is_finite(wArb))
+			continue;
+
+		arb_get_lbound_arf(boundArf, wArb, prec);
+		Ty low = RoundDown<Ty>(boundArf);
+		arb_get_ubound_arf(boundArf, wArb, prec);
+		Ty high = RoundUp<Ty>(boundArf);
+
+		if (high <= std::nextafter(low, (Ty)INFINITY))
+			return { low, high };
+	}
+
+	std::cerr << std::format("arb_lambertw did not converge x: {}\n", x);
+	std::terminate();
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <arb.h>
+
+#include "../src/Interval.h"
+
+// Baseline evaluator using FLINT's arb_lambertw, doubling the precision until the enclosure
+// rounds to one ulp. Slower than ReferenceW, it is kept to measure against and cross-check.
+class ArbW
+{
+public:
+	ArbW();
+	~ArbW();
+
+	Interval W0(double x);
+	Interval Wm1(double x);
+	Intervalf W0(float x);
+	Intervalf Wm1(float x);
+
+private:
+	arb_t xArb, wArb;
+	arf_t boundArf;
+
+	template <typename Ty, typename IntervalTy>
+	IntervalTy Evaluate(Ty x, int flags);
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <ReferenceLambertW.h>
+#include "ArbW.h"
+#include "MpfrW.h"
+
+/*
+Evaluator backends behind one interface, so the benchmark and test drivers can run any of them on
+the same inputs
+	reference	ReferenceW / ReferenceWf
+	illinois	ReferenceW / ReferenceWf with SearchMethod::Illinois
+	newton		ReferenceW / ReferenceWf with SearchMethod::Newton
+	arb			ArbW, FLINT's arb_lambertw with precision doubling
+	mpfr		MpfrW, MPFR Newton iteration with verified signs
+*/
+inline constexpr const char* EngineNames[] = { "reference", "illinois", "newton", "arb", "mpfr" };
+
+template <typename Ty>
+class Engine
+{
+public:
+	using IntervalTy = BasicInterval<Ty>;
+
+	virtual ~Engine() = default;
+
+	virtual IntervalTy W0(Ty x) = 0;
+	virtual IntervalTy Wm1(Ty x) = 0;
+
+	// Builds lazily created state ahead of the first call, where the backend supports it
+	virtual void Warmup() {}
+};
+
+template <typename Ty, typename Impl>
+class EngineImpl final : public Engine<Ty>
+{
+public:
+	using IntervalTy = typename Engine<Ty>::IntervalTy;
+
+	template <typename... Args>
+	explicit EngineImpl(Args&&... args)
+		: impl(std::forward<Args>(args)...) {}
+
+	IntervalTy W0(Ty x) override
+	{
+		return impl.W0(x);
+	}
+
+	IntervalTy Wm1(Ty x) override
+	{
+		return impl.Wm1(x);
+	}
+
+	void Warmup() override
+	{
+		if constexpr (requires { Impl::Warmup(); })
+			Impl::Warmup();
+	}
+
+private:
+	Impl impl;
+};
+
+// Search method of a ReferenceW engine, Bisection for the others
+inline SearchMethod GetSearchMethod(std::string_view name)
+{
+	if (name == "illinois")
+		return SearchMethod::Illinois;
+	if (name == "newton")
+		return SearchMethod::Newton;
+	return SearchMethod::Bisection;
+}
+
+// Null if the name is unknown
+template <typename Ty>
+std::unique_ptr<Engine<Ty>> MakeEngine(std::string_view name)
+{
+	if (name == "reference" || name == "illinois" || name == "newton")
+		return std::make_unique<EngineImpl<Ty, BasicReferenceW<Ty>>>(GetSearchMethod(name));
+	if (name == "arb")
+		return std::make_unique<EngineImpl<Ty, ArbW>>();
+	if (name == "mpfr")
+		return std::make_unique<EngineImpl<Ty, MpfrW>>();
+	return nullptr;
+}
@@ -0,0 +1,158 @@
+#include "../include/config.h"
+#include "MpfrW.h"
+
+#include <cfloat>
+#include <cmath>
+#include <limits>
+
+#include <iostream>
+#include <format>
+#include <exception>
+
+#include <mpfr.h>
+
+#include "../src/rndutil.h"
+#include "../src/approx.h"
+#include "../src/ReferenceWTraits.h"
+
+// === Parameters ===
+static constexpr mpfr_prec_t MaxPrec = 1 << 16;
+static constexpr size_t MaxNewtonSteps = 64;
+static constexpr size_t MaxWalkSteps = 8; // ulps walked from the Newton result to the root
+static constexpr int Inconclusive = 2;
+// ==================
+
+MpfrW::MpfrW()
+{
+	for (mpfr_ptr v : { xMpfr, w, expW, num, den, expDown, expUp, low, high })
+		mpfr_init2(v, 53);
+}
+
+MpfrW::~MpfrW()
+{
+	for (mpfr_ptr v : { xMpfr, w, expW, num, den, expDown, expUp, low, high })
+		mpfr_clear(v);
+}
+
+Interval MpfrW::W0(double x)
+{
+	return Evaluate<double, Interval>(x, true);
+}
+
+Interval MpfrW::Wm1(double x)
+{
+	return Evaluate<double, Interval>(x, false);
+}
+
+Intervalf MpfrW::W0(float x)
+{
+	return Evaluate<float, Intervalf>(x, true);
+}
+
+Intervalf MpfrW::Wm1(float x)
+{
+	return Evaluate<float, Intervalf>(x, false);
+}
+
+void MpfrW::SetPrec(mpfr_prec_t prec)
+{
+	// x and the probed points are exact at any precision above the type's
+	for (mpfr_ptr v : { xMpfr, w, expW, num, den, expDown, expUp, low, high })
+		mpfr_set_prec(v, prec);
+}
+
+// Sign of w e^w - x, or Inconclusive at the current precision
+template <typename Ty>
+int MpfrW::GetSign(Ty wt)
+{
+	mpfr_set_d(num, wt, MPFR_RNDN);
+	ExpUpDown(expDown, expUp, num);
+
+	bool isNeg = wt < 0;
+	mpfr_mul(low, num, isNeg ? expUp : expDown, MPFR_RNDD);
+	mpfr_sub(low, low, xMpfr, MPFR_RNDD);
+	mpfr_mul(high, num, isNeg ? expDown : expUp, MPFR_RNDU);
+	mpfr_sub(high, high, xMpfr, MPFR_RNDU);
+
+	if (mpfr_sgn(low) > 0)
+		return 1;
+	if (mpfr_sgn(high) < 0)
+		return -1;
+	return Inconclusive;
+}
+
+template <typename Ty, typename IntervalTy>
+IntervalTy MpfrW::Evaluate(Ty x, bool isW0)
+{
+	// Edge cases, as ReferenceW
+	if (x < ReferenceWTraits<Ty>::EmUp)
+		return { NAN, NAN };
+	if (isW0)
+	{
+		if (x == INFINITY)
+			return { std::numeric_limits<Ty>::max(), INFINITY };
+		if (x == 0)
+			return { 0, 0 };
+	}
+	else if (x >= 0)
+		return { NAN, NAN };
+
+	// Initial approximation, as ReferenceW for double since the seed is evaluated in double
+	using Traits = ReferenceWTraits<double>;
+	double seed;
+	if (isW0)
+		seed = (x < Traits::W0NearBranch) ? NearBranchW0((double)x) : ((x < Traits::W0SecondApprox) ? FirstApproxW0((double)x) : SecondApproxW0((double)x));
+	else
+		seed = (x < Traits::Wm1NearBranch) ? NearBranchWm1((double)x) : GeneralWm1((double)x);
+
+	for (mpfr_prec_t prec = 2 * std::numeric_limits<Ty>::digits + 16; prec <= MaxPrec; prec *= 2)
+	{
+		SetPrec(prec);
+		mpfr_set_d(xMpfr, x, MPFR_RNDN);
+		mpfr_set_d(w, seed, MPFR_RNDN);
+
+		// Newton: w -= (w e^w - x) / (e^w (w + 1))
+		for (size_t i = 0; i < MaxNewtonSteps; i++)
+		{
+			mpfr_exp(expW, w, MPFR_RNDN);
+			mpfr_mul(num, w, expW, MPFR_RNDN);
+			mpfr_sub(num, num, xMpfr, MPFR_RNDN);
+			mpfr_add_ui(den, w, 1, MPFR_RNDN);
+			mpfr_mul(den, den, expW, MPFR_RNDN);
+			if (mpfr_zero_p(num) || mpfr_zero_p(den))
+				break;
+
+			mpfr_div(num, num, den, MPFR_RNDN);
+			mpfr_sub(w, w, num, MPFR_RNDN);
+			if (mpfr_get_exp(num) < mpfr_get_exp(w) - prec + 4)
+				break;
+		}
+
+		Ty wt;
+		if constexpr (std::is_same_v<Ty, float>)
+			wt = mpfr_get_flt(w, MPFR_RNDN);
+		else
+			wt = mpfr_get_d(w, MPFR_RNDN);
+
+		// Walk towards the root until the sign changes between neighbours
+		int sign = GetSign(wt);
+		if (sign == Inconclusive)
+			continue;
+
+		Ty direction = ((sign > 0) == isW0) ? -INFINITY : INFINITY;
+		for (size_t step = 0; step < MaxWalkSteps; step++)
+		{
+			Ty next = std::nextafter(wt, direction);
+			int nextSign = GetSign(next);
+			if (nextSign == Inconclusive)
+				break;
+
+			if (nextSign != sign)
+				return { std::min(wt, next), std::max(wt, next) };
+			wt = next;
+		}
+	}
+
+	std::cerr << std::format("MPFR Newton did not converge x: {}\n", x);
+	std::terminate();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <mpfr.h>
+
+#include "../src/Interval.h"
+
+// Baseline evaluator using only MPFR: Newton's method from the double initial approximations,
+// then the signs of w e^w - x at the neighbouring floats are verified with directed rounding.
+// The working precision doubles whenever a sign is inconclusive.
+class MpfrW
+{
+public:
+	MpfrW();
+	~MpfrW();
+
+	Interval W0(double x);
+	Interval Wm1(double x);
+	Intervalf W0(float x);
+	Intervalf Wm1(float x);
+
+private:
+	mpfr_t xMpfr, w, expW, num, den, expDown, expUp, low, high;
+
+	void SetPrec(mpfr_prec_t prec);
+
+	template <typename Ty>
+	int GetSign(Ty wt);
+
+	template <typename Ty, typename IntervalTy>
+	IntervalTy Evaluate(Ty x, bool isW0);
+};
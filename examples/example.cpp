@@ -19,7 +19,7 @@ void SpeedTest(size_t arrSize)
 		data.push_back(dist(gen));
 
 	// Create evaluator object
-	std::conditional_t<std::is_same_v<Ty, float>, ReferenceWf, ReferenceW> evaluator;
+	BasicReferenceW<Ty> evaluator;
 
 	TIMER(t);
 	Ty _ = 0;
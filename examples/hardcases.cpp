@@ -0,0 +1,386 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <format>
+#include <algorithm>
+#include <charconv>
+#include <string>
+#include <cstring>
+#include <bit>
+#include <cmath>
+#include <cfloat>
+
+#include <arb.h>
+
+#include <ReferenceLambertW.h>
+#include "../src/Ordered.h"
+
+/*
+Hard-case search for W0 and Wm1 in double precision (Lefevre's method)
+
+Over a block of N consecutive doubles x_k = x0 + k u, W is replaced by its tangent line
+	W(x_k) = W(x0) + k u W'(x0) + err,	|err| <= (N u)^2 / 2 * max|W''|
+Measured in units of g (half an ulp of W), the distance of W(x_k) to the nearest double or
+midpoint is the distance of (a + k b) to the nearest integer. Scaling by 2^64 turns this into
+min (A k + B) mod 2^64 over the block, which MinMod solves in O(log N) steps. Blocks whose minimum
+is above the threshold are cleared at once, the rest are subdivided down to individual inputs.
+
+Every candidate is then evaluated exactly with arb and checked against ReferenceW. For candidates
+whose W(x) is near a double m, the residual |m e^m - x| / |x| is the quantity GetMidpointSign has
+to resolve, so its magnitude gives the working precision needed for that input.
+*/
+
+// === Parameters ===
+constexpr size_t threshold = 24;	// Report inputs within 2^-threshold g of the grid
+constexpr size_t maxBlock = 1 << 16;
+constexpr size_t minBlock = 16;	// Smaller blocks are evaluated point by point
+constexpr slong prec = 256;
+// ==================
+
+using u128 = unsigned __int128;
+
+struct HardCase
+{
+	double x;
+	double nearest;
+	bool isMidpoint;
+	bool isAmbiguous;	// ReferenceW threw AmbiguousSignError
+	double distance;	// In units of g
+	slong residualBits;	// -log2(|m e^m - x| / |x|), 0 if the sign test is trivial
+};
+
+// min_{0 <= k < n} (a k + b) mod m
+static u128 MinMod(u128 n, u128 m, u128 a, u128 b)
+{
+	a %= m;
+	b %= m;
+	if (a == 0 || n == 1)
+		return b;
+
+	// Skip to the first wrap, values before it are all larger than b
+	if (b >= a)
+	{
+		u128 k = (m - b + a - 1) / a;
+		if (k >= n)
+			return b;
+		n -= k;
+		b = b + k * a - m;
+	}
+
+	// The minimum is attained right after one of the J wraps, where the values are (b - j r) mod a
+	u128 J = (a * (n - 1) + b) / m;
+	u128 r = m % a;
+	if (J == 0 || r == 0)
+		return b;
+
+	// (b - j r) mod a decreases in runs, each run ends on (b + t a) mod r
+	u128 T = (J * r > b) ? (J * r - b + a - 1) / a : 0;
+	u128 last = b + T * a - J * r;
+	if (T == 0)
+		return last;
+
+	return std::min(last, MinMod(T, r, a % r, b % r));
+}
+
+class HardCaseSearch
+{
+public:
+	HardCaseSearch(int64_t branch_)
+		: branch(branch_)
+	{
+		arb_init(xArb);
+		arb_init(wArb);
+		arb_init(tArb);
+		arb_init(uArb);
+		arf_init(bound);
+		fmpz_init(z);
+	}
+
+	~HardCaseSearch()
+	{
+		arb_clear(xArb);
+		arb_clear(wArb);
+		arb_clear(tArb);
+		arb_clear(uArb);
+		arf_clear(bound);
+		fmpz_clear(z);
+	}
+
+	// Searches the n consecutive doubles starting at ordered integer o0
+	void Search(int64_t o0, size_t n)
+	{
+		double x0 = FromOrdered<double>(o0);
+		double xLast = FromOrdered<double>(o0 + (int64_t)n - 1);
+		double w0 = ApproxW(x0);
+		double wLast = ApproxW(xLast);
+
+		if (n <= minBlock || !std::isfinite(w0) || !std::isfinite(wLast))
+		{
+			for (size_t k = 0; k < n; k++)
+				Check(FromOrdered<double>(o0 + (int64_t)k));
+			return;
+		}
+
+		// Split blocks which cross a binade of x or W
+		int ex0, exLast, ew0, ewLast;
+		std::frexp(x0, &ex0);
+		std::frexp(xLast, &exLast);
+		std::frexp(w0, &ew0);
+		std::frexp(wLast, &ewLast);
+
+		if (ex0 != exLast || ew0 != ewLast || !LinearSearch(x0, n, ew0))
+		{
+			size_t half = n / 2;
+			Search(o0, half);
+			Search(o0 + (int64_t)half, n - half);
+		}
+	}
+
+	const std::vector<HardCase>& GetCases() const
+	{
+		return cases;
+	}
+
+	size_t GetNumChecked() const
+	{
+		return numChecked;
+	}
+
+	size_t GetNumFailures() const
+	{
+		return numFailures;
+	}
+
+private:
+	int64_t branch;
+	arb_t xArb, wArb, tArb, uArb;
+	arf_t bound;
+	fmpz_t z;
+	ReferenceW evaluator;
+	std::vector<HardCase> cases;
+	size_t numChecked = 0;
+	size_t numFailures = 0;	// Results which do not enclose W
+
+	static double Ulp(double x)
+	{
+		int e;
+		std::frexp(x, &e);
+		return std::ldexp(1.0, std::max(e - 53, -1074));
+	}
+
+	void LambertW(arb_t res, const arb_t x)
+	{
+		arb_lambertw(res, x, (branch == 0) ? 0 : 1, prec);
+	}
+
+	double ApproxW(double x)
+	{
+		arb_set_d(xArb, x);
+		LambertW(wArb, xArb);
+		return arf_get_d(arb_midref(wArb), ARF_RND_NEAR);
+	}
+
+	// Upper bound on |t| as a double
+	double UpperBound(const arb_t t)
+	{
+		arb_get_abs_ubound_arf(bound, t, 53);
+		return arf_get_d(bound, ARF_RND_UP);
+	}
+
+	// t mod 2^64 rounded to nearest, returns the rounding error bound in the same units
+	double Reduce(const arb_t t, uint64_t& out)
+	{
+		arf_get_fmpz(z, arb_midref(t), ARF_RND_NEAR);
+		fmpz_fdiv_r_2exp(z, z, 64);
+		out = fmpz_get_ui(z);
+		return 0.5 + mag_get_d(arb_radref(t));
+	}
+
+	// Returns false if the tangent line is not accurate enough over the block
+	bool LinearSearch(double x0, size_t n, int ew)
+	{
+		double u = Ulp(x0);
+		slong s = 118 - ew;	// W * 2^s is W in units of 2^-64 g
+
+		// Curvature bound over the whole block
+		// W'' = -W^2 (W + 2) / (x^2 (1 + W)^3)
+		arf_t lo, hi;
+		arf_init(lo);
+		arf_init(hi);
+		arf_set_d(lo, x0);
+		arf_set_d(hi, x0 + (double)(n - 1) * u);
+		arb_set_interval_arf(xArb, lo, hi, prec);
+		arf_clear(lo);
+		arf_clear(hi);
+
+		LambertW(wArb, xArb);
+		arb_add_ui(tArb, wArb, 1, prec);
+		arb_pow_ui(tArb, tArb, 3, prec);
+		arb_mul(tArb, tArb, xArb, prec);
+		arb_mul(tArb, tArb, xArb, prec);
+		arb_add_ui(uArb, wArb, 2, prec);
+		arb_mul(uArb, uArb, wArb, prec);
+		arb_mul(uArb, uArb, wArb, prec);
+		arb_div(tArb, uArb, tArb, prec);
+		if (!arb_is_finite(tArb))
+			return false;
+
+		// (N u)^2 / 2 * max|W''| in units of 2^-64 g
+		double h = (double)(n - 1) * u;
+		double curvature = std::ldexp(UpperBound(tArb) * h * h * 0.5, s);
+
+		// Error budget is a quarter of the search window
+		double window = std::ldexp(1.0, 64 - threshold);
+		if (!(curvature < window / 4))
+			return false;
+
+		// A = u W'(x0) 2^s, B = W(x0) 2^s
+		// W' = W / (x (1 + W))
+		arb_set_d(xArb, x0);
+		LambertW(wArb, xArb);
+		arb_add_ui(tArb, wArb, 1, prec);
+		arb_mul(tArb, tArb, xArb, prec);
+		arb_div(tArb, wArb, tArb, prec);
+		arb_mul_2exp_si(tArb, tArb, s);
+		arb_set_d(uArb, u);
+		arb_mul(tArb, tArb, uArb, prec);
+		uint64_t A, B;
+		double slopeError = Reduce(tArb, A);
+		arb_mul_2exp_si(wArb, wArb, s);
+		double offsetError = Reduce(wArb, B);
+
+		// Total error of (A k + B) over the block
+		double error = curvature + offsetError + slopeError * (double)n;
+		if (!(error < window / 4))
+			return false;
+
+		// Distance to the grid is below D iff (A k + B + D) mod 2^64 < 2D
+		uint64_t D = (uint64_t)(window + error);
+		Scan(x0, u, 0, n, A, B + D, 2 * (u128)D);
+		return true;
+	}
+
+	void Scan(double x0, double u, size_t k0, size_t n, uint64_t A, uint64_t B, u128 width)
+	{
+		static constexpr u128 M = (u128)1 << 64;
+
+		uint64_t offset = B + A * (uint64_t)k0;
+		if (MinMod(n, M, A, offset) >= width)
+			return;
+
+		if (n <= minBlock)
+		{
+			for (size_t k = 0; k < n; k++)
+				if ((u128)(uint64_t)(offset + A * (uint64_t)k) < width)
+					Check(x0 + (double)(k0 + k) * u);
+			return;
+		}
+
+		size_t half = n / 2;
+		Scan(x0, u, k0, half, A, B, width);
+		Scan(x0, u, k0 + half, n - half, A, B, width);
+	}
+
+	// Exact evaluation of a single input
+	void Check(double x)
+	{
+		numChecked++;
+
+		arb_set_d(xArb, x);
+		LambertW(wArb, xArb);
+		if (!arb_is_finite(wArb))
+			return;
+
+		// Distance to the nearest point of the 54 bit grid
+		int ew;
+		std::frexp(arf_get_d(arb_midref(wArb), ARF_RND_NEAR), &ew);
+		arb_mul_2exp_si(tArb, wArb, 54 - ew);
+		arf_get_fmpz(z, arb_midref(tArb), ARF_RND_NEAR);
+		arb_sub_fmpz(tArb, tArb, z, prec);
+		double distance = UpperBound(tArb);
+		if (distance >= std::ldexp(1.0, -(int)threshold))
+			return;
+
+		bool isMidpoint = !fmpz_is_even(z);
+		arb_set_fmpz(tArb, z);
+		arb_mul_2exp_si(tArb, tArb, ew - 54);
+		double nearest = arf_get_d(arb_midref(tArb), ARF_RND_NEAR);
+
+		// Residual of the sign test at the nearest double
+		slong residualBits = 0;
+		if (!isMidpoint && nearest < x)
+		{
+			arb_set_d(tArb, nearest);
+			arb_exp(uArb, tArb, prec);
+			arb_mul(uArb, uArb, tArb, prec);
+			arb_sub(uArb, uArb, xArb, prec);
+			arb_div(uArb, uArb, xArb, prec);
+			residualBits = -arf_abs_bound_lt_2exp_si(arb_midref(uArb));
+		}
+
+		// ReferenceW must enclose the exact value
+		bool isAmbiguous = false;
+		try
+		{
+			auto [inf, sup] = (branch == 0) ? evaluator.W0(x) : evaluator.Wm1(x);
+			arb_set_d(tArb, inf);
+			arb_sub(tArb, wArb, tArb, prec);
+			arb_set_d(uArb, sup);
+			arb_sub(uArb, uArb, wArb, prec);
+			if (!arb_is_nonnegative(tArb) || !arb_is_nonnegative(uArb))
+			{
+				std::cerr << std::format("ReferenceW does not enclose W at x: {}\n", x);
+				numFailures++;
+			}
+		}
+		catch (const AmbiguousSignError&)
+		{
+			std::cerr << std::format("Ambiguous sign test at x: {}\n", x);
+			isAmbiguous = true;
+		}
+
+		cases.push_back({ x, nearest, isMidpoint, isAmbiguous, distance, residualBits });
+	}
+};
+
+int main(int argc, char** argv)
+{
+	// hardcases [branch] [start] [count]
+	int64_t branch = 0;
+	double start = 1.0;
+	size_t count = 1 << 24;
+	if (argc > 1) std::from_chars(argv[1], argv[1] + strlen(argv[1]), branch);
+	if (argc > 2) std::from_chars(argv[2], argv[2] + strlen(argv[2]), start);
+	if (argc > 3) std::from_chars(argv[3], argv[3] + strlen(argv[3]), count);
+
+	HardCaseSearch search{ branch };
+	int64_t o = ToOrdered(start);
+	for (size_t done = 0; done < count;)
+	{
+		size_t n = std::min(maxBlock, count - done);
+		search.Search(o, n);
+		o += (int64_t)n;
+		done += n;
+	}
+
+	// Rank by distance to the grid
+	std::vector<HardCase> cases = search.GetCases();
+	std::sort(cases.begin(), cases.end(), [](const HardCase& a, const HardCase& b) { return a.distance < b.distance; });
+
+	std::ofstream file{ "hardcases.csv" };
+	file << "x,Nearest,Kind,Log2 Distance,Residual Bits\n";
+	slong maxResidualBits = 0;
+	size_t numAmbiguous = 0;
+	for (const HardCase& c : cases)
+	{
+		const char* kind = c.isAmbiguous ? "ambiguous" : c.isMidpoint ? "midpoint" : "double";
+		file << std::format("{:.17e},{:.17e},{},{:.3f},{}\n", c.x, c.nearest, kind, log2(c.distance), c.residualBits);
+		maxResidualBits = std::max(maxResidualBits, c.residualBits);
+		numAmbiguous += c.isAmbiguous;
+	}
+
+	std::cout << std::format("Searched {} inputs, checked {} exactly, {} hard cases\n", count, search.GetNumChecked(), cases.size());
+	std::cout << std::format("Largest sign test residual: 2^-{}\n", maxResidualBits);
+	std::cout << std::format("{} ambiguous sign tests, {} enclosure failures\n", numAmbiguous, search.GetNumFailures());
+	return (search.GetNumFailures() == 0) ? 0 : 1;
+}
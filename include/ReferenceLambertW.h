@@ -1,4 +1,3 @@
 #pragma once
 #include "config.h"
-#include "../src/ReferenceW.h"
-#include "../src/ReferenceWf.h"
\ No newline at end of file
+#include "../src/ReferenceW.h"
\ No newline at end of file
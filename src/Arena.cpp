@@ -0,0 +1,179 @@
+#include "Arena.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <bit>
+#include <algorithm>
+#include <iostream>
+#include <exception>
+
+#include <gmp.h>
+#include <arb.h>
+
+// === Parameters ===
+static constexpr size_t MinClassBits = 4; // 16 bytes
+static constexpr size_t NumClasses = 13; // Up to 64KiB, larger blocks go straight to the system
+static constexpr size_t MaxFreeBytes = 1 << 20; // Per class and thread, further frees go to the system
+// ==================
+
+static constexpr uint32_t LargeClass = UINT32_MAX;
+
+// Precedes every block, sized to keep the payload 16 byte aligned
+struct alignas(16) BlockHeader
+{
+	uint32_t sizeClass;
+	size_t size; // Requested size, for realloc
+};
+
+struct FreeBlock
+{
+	FreeBlock* next;
+};
+
+static std::atomic<size_t> systemAllocations = 0;
+
+struct Pool
+{
+	FreeBlock* freeLists[NumClasses] = {};
+	size_t freeCounts[NumClasses] = {};
+
+	~Pool();
+};
+
+static thread_local Pool pool;
+
+// FLINT may free its thread local caches after the pool is destroyed, those blocks go to the system
+static thread_local bool poolDestroyed = false;
+
+Pool::~Pool()
+{
+	for (FreeBlock*& list : freeLists)
+	{
+		while (list)
+		{
+			FreeBlock* next = list->next;
+			std::free(reinterpret_cast<BlockHeader*>(list) - 1);
+			list = next;
+		}
+	}
+	poolDestroyed = true;
+}
+
+static uint32_t GetSizeClass(size_t size)
+{
+	if (size <= ((size_t)1 << MinClassBits))
+		return 0;
+	size_t bits = std::bit_width(size - 1);
+	return (bits - MinClassBits < NumClasses) ? (uint32_t)(bits - MinClassBits) : LargeClass;
+}
+
+static size_t GetClassSize(uint32_t sizeClass)
+{
+	return (size_t)1 << (sizeClass + MinClassBits);
+}
+
+static void* Allocate(size_t size)
+{
+	uint32_t sizeClass = GetSizeClass(size);
+	if (sizeClass != LargeClass && !poolDestroyed)
+	{
+		FreeBlock*& list = pool.freeLists[sizeClass];
+		if (list)
+		{
+			FreeBlock* block = list;
+			list = block->next;
+			pool.freeCounts[sizeClass]--;
+			BlockHeader* header = reinterpret_cast<BlockHeader*>(block) - 1;
+			header->size = size;
+			return block;
+		}
+	}
+
+	systemAllocations.fetch_add(1, std::memory_order_relaxed);
+	size_t capacity = (sizeClass == LargeClass) ? size : GetClassSize(sizeClass);
+	BlockHeader* header = static_cast<BlockHeader*>(std::malloc(sizeof(BlockHeader) + capacity));
+	if (!header)
+	{
+		std::cerr << "Arena allocator out of memory\n";
+		std::terminate();
+	}
+	header->sizeClass = sizeClass;
+	header->size = size;
+	return header + 1;
+}
+
+static void Free(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+	uint32_t sizeClass = header->sizeClass;
+	if (sizeClass == LargeClass || poolDestroyed || pool.freeCounts[sizeClass] >= (MaxFreeBytes >> (sizeClass + MinClassBits)))
+	{
+		std::free(header);
+		return;
+	}
+
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	FreeBlock*& list = pool.freeLists[sizeClass];
+	block->next = list;
+	list = block;
+	pool.freeCounts[sizeClass]++;
+}
+
+static void* Reallocate(void* ptr, size_t size)
+{
+	if (!ptr)
+		return Allocate(size);
+
+	// Grow or shrink in place while the block is large enough
+	BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+	if (header->sizeClass != LargeClass && size <= GetClassSize(header->sizeClass))
+	{
+		header->size = size;
+		return ptr;
+	}
+
+	void* next = Allocate(size);
+	std::memcpy(next, ptr, std::min(size, header->size));
+	Free(ptr);
+	return next;
+}
+
+static void* AllocateZeroed(size_t num, size_t size)
+{
+	if (size != 0 && num > SIZE_MAX / size)
+	{
+		std::cerr << "Arena allocator size overflow\n";
+		std::terminate();
+	}
+
+	void* ptr = Allocate(num * size);
+	std::memset(ptr, 0, num * size);
+	return ptr;
+}
+
+// GMP passes the old and freed sizes, which the headers already record
+static void* GmpReallocate(void* ptr, size_t, size_t size)
+{
+	return Reallocate(ptr, size);
+}
+
+static void GmpFree(void* ptr, size_t)
+{
+	Free(ptr);
+}
+
+void InstallArenaAllocator()
+{
+	__flint_set_memory_functions(Allocate, AllocateZeroed, Reallocate, Free);
+	mp_set_memory_functions(Allocate, GmpReallocate, GmpFree);
+}
+
+size_t GetSystemAllocations()
+{
+	return systemAllocations.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+
+/*
+Thread local allocator for FLINT and GMP memory
+
+Blocks are rounded up to a power of two size class and recycled through per thread free lists, so
+once the classes used by evaluation are populated the system allocator is never reached and threads
+never contend on it. A bump arena reset between evaluations isn't possible, as evaluator limbs and
+FLINT's constant caches live across calls. Blocks may be freed on any thread, they join that
+thread's free lists up to a per class cap and go back to the system past it, so a thread which only
+frees what others allocate doesn't grow without bound.
+
+Must be installed before FLINT, GMP or MPFR allocate anything, as blocks from the previous
+allocator can't be told apart from pool blocks.
+*/
+void InstallArenaAllocator();
+
+// Number of times the pool has fallen back to the system allocator, over all threads
+size_t GetSystemAllocations();
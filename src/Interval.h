@@ -1,11 +1,10 @@
 #pragma once
 
-struct Interval
+template <typename Ty>
+struct BasicInterval
 {
-	double inf, sup;
+	Ty inf, sup;
 };
 
-struct Intervalf
-{
-	float inf, sup;
-};
\ No newline at end of file
+using Interval = BasicInterval<double>;
+using Intervalf = BasicInterval<float>;
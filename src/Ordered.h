@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+#include <bit>
+#include <limits>
+#include <type_traits>
+
+// Maps floating point values onto integers which preserve their order, consecutive values map to
+// consecutive integers
+template <typename Ty>
+using OrderedInt = std::conditional_t<std::is_same_v<Ty, float>, int32_t, int64_t>;
+
+template <typename Ty>
+OrderedInt<Ty> ToOrdered(Ty x)
+{
+	OrderedInt<Ty> i = std::bit_cast<OrderedInt<Ty>>(x);
+	return (i < 0) ? -(i & std::numeric_limits<OrderedInt<Ty>>::max()) : i;
+}
+
+template <typename Ty>
+Ty FromOrdered(OrderedInt<Ty> o)
+{
+	return (o < 0) ? -std::bit_cast<Ty>((OrderedInt<Ty>)-o) : std::bit_cast<Ty>(o);
+}
+
+// Number of ulps from low up to high, unsigned as a range across zero may exceed OrderedInt's maximum
+template <typename Ty>
+std::make_unsigned_t<OrderedInt<Ty>> UlpDistance(Ty low, Ty high)
+{
+	using Width = std::make_unsigned_t<OrderedInt<Ty>>;
+	return (Width)ToOrdered(high) - (Width)ToOrdered(low);
+}
@@ -4,6 +4,9 @@
 #include <cfloat>
 #include <cmath>
 #include <cfenv>
+#include <limits>
+#include <algorithm>
+#include <utility>
 
 #include <iostream>
 #include <format>
@@ -16,221 +19,483 @@
 
 #include "rndutil.h"
 #include "halley.h"
-
-static constexpr double EM_UP = -0.3678794411714423; // (-1/e) rounded towards +Inf
-
-ReferenceW::ReferenceW()
+#include "approx.h"
+#include "dispatch.h"
+#include "Ordered.h"
+#include "arbutil.h"
+#include "ReferenceWTraits.h"
+
+template <typename Ty>
+BasicReferenceW<Ty>::BasicReferenceW(SearchMethod method_)
+	: method(method_)
 {
 	arb_init(xArb);
 	arb_init(mArb);
 	arb_init(yArb);
+	arb_init(anchorArb);
+	arb_init(anchorExpArb);
+	arb_init(dArb);
+	arb_init(seriesArb);
+	mag_init(errMag);
+	arb_init(wArb);
+	arb_init(derivArb);
+	arf_init(boundArf);
 }
 
-ReferenceW::~ReferenceW()
+template <typename Ty>
+BasicReferenceW<Ty>::~BasicReferenceW()
 {
 	arb_clear(xArb);
 	arb_clear(mArb);
 	arb_clear(yArb);
+	arb_clear(anchorArb);
+	arb_clear(anchorExpArb);
+	arb_clear(dArb);
+	arb_clear(seriesArb);
+	mag_clear(errMag);
+	arb_clear(wArb);
+	arb_clear(derivArb);
+	arf_clear(boundArf);
 }
 
-Interval ReferenceW::W0(double x)
+template <typename Ty>
+auto BasicReferenceW<Ty>::W0(Ty x, size_t maxUlps) -> IntervalTy
 {
 #if REFERENCEW_STATS
 	numEvals++;
 #endif
 
 	// Edge cases
-	if (x < EM_UP)
+	if (x < ReferenceWTraits<Ty>::EmUp)
 		return { NAN, NAN };
 	if (x == INFINITY)
-		return { DBL_MAX, INFINITY };
+		return { std::numeric_limits<Ty>::max(), INFINITY };
 	if (x == 0)
 		return { 0, 0 };
 
-	// Save current rounding mode
-	int initialRnd = fegetround();
+	RoundingScope rounding;
 
 	// === Compute Bracket ===
 	auto [low, high] = W0Bracket(x);
+	if (maxUlps == BracketOnly)
+		return { low, high };
 
 	// === Bisection ===
-	auto ret = Bisection(x, low, high, true);
-	if (ret.inf != ret.sup && ret.sup != std::nextafter(ret.inf, INFINITY))
+	maxUlps = std::max<size_t>(maxUlps, 1);
+	auto ret = Search(x, low, high, true, maxUlps);
+	if (!budget && UlpDistance(ret.inf, ret.sup) > maxUlps)
 	{
 		std::cerr << std::format("Bracket too wide x: {}\n", x);
 		std::terminate();
 	}
 
-	// Restore rounding mode
-	fesetround(initialRnd);
-
 	return ret;
 }
 
-Interval ReferenceW::Wm1(double x)
+template <typename Ty>
+auto BasicReferenceW<Ty>::Wm1(Ty x, size_t maxUlps) -> IntervalTy
 {
 #if REFERENCEW_STATS
 	numEvals++;
 #endif
 
 	// Edge cases
-	if (x < EM_UP || x >= 0)
+	if (x < ReferenceWTraits<Ty>::EmUp || x >= 0)
 		return { NAN, NAN };
 
-	// Save current rounding mode
-	int initialRnd = fegetround();
+	RoundingScope rounding;
 
 	// === Compute Bracket ===
 	auto [low, high] = Wm1Bracket(x);
+	if (maxUlps == BracketOnly)
+		return { low, high };
 
 	// === Bisection ===
-	auto ret = Bisection(x, low, high, false);
-	if (ret.inf != ret.sup && ret.sup != std::nextafter(ret.inf, INFINITY))
+	maxUlps = std::max<size_t>(maxUlps, 1);
+	auto ret = Search(x, low, high, false, maxUlps);
+	if (!budget && UlpDistance(ret.inf, ret.sup) > maxUlps)
 	{
 		std::cerr << std::format("Bracket too wide x: {}\n", x);
 		std::terminate();
 	}
 
-	// Restore rounding mode
-	fesetround(initialRnd);
-
 	return ret;
 }
 
-#if REFERENCEW_STATS
-double ReferenceW::GetHighPrecRate() const
+template <typename Ty>
+auto BasicReferenceW<Ty>::W0(Ty x, const Budget& budget_) -> Partial
 {
-	return (double)numHighPrec / totalBisections;
+	BudgetScope scope{ *this, budget_ };
+	IntervalTy ret = W0(x);
+
+	return { ret, UlpDistance(ret.inf, ret.sup) <= 1 };
 }
 
-size_t ReferenceW::GetMaxBisections() const
+template <typename Ty>
+auto BasicReferenceW<Ty>::Wm1(Ty x, const Budget& budget_) -> Partial
 {
-	return maxBisections;
+	BudgetScope scope{ *this, budget_ };
+	IntervalTy ret = Wm1(x);
+
+	return { ret, UlpDistance(ret.inf, ret.sup) <= 1 };
 }
 
-double ReferenceW::GetAvgBisections() const
+template <typename Ty>
+auto BasicReferenceW<Ty>::Refine(Ty x, const Partial& partial, const Budget& budget_) -> Partial
 {
-	return (double)totalBisections / numEvals;
-}
-#endif
+	if (partial.isTight)
+		return partial;
 
-static inline double AddEm(double x)
-{
-	static constexpr double emHigh = 0.36787944117144232160;
-	static constexpr double emLow = -1.2428753672788363168e-17;
-
-	return (x + emHigh) + emLow;
-}
-
-static inline double NearBranchW0(double x)
-{
-	static constexpr double s2e = 2.331643981597124;
-	static constexpr double P[] = {
-		-1.00000000000000000000,
-		0.99999999999998689937,
-		-0.33333333333171155655,
-		0.15277777769847986078,
-		-0.07962962759798784818,
-		0.04450228328389740917,
-		-0.02598439214142129680,
-		0.01563333375832150554,
-		-0.00960508856297833703,
-		0.00596982547465134492,
-		-0.00368441824865070513,
-		0.00216878673408957843,
-		-0.00113330227139719539,
-		0.00047252681627728467,
-		-0.00013420111092875102,
-		0.00001887878365359131,
-	};
+	RoundingScope rounding;
+	BudgetScope scope{ *this, budget_ };
 
-	double p = sqrt(AddEm(x)) * s2e;
+	// W0 enclosures lie above -1 and Wm1 enclosures at or below it
+	auto [inf, sup] = partial.enclosure;
+	IntervalTy ret = Search(x, inf, sup, sup > -1, 1);
 
-	double value = P[15];
-	for (size_t i = 0; i < 15; i++)
-		value = value * p + P[14 - i];
+	return { ret, UlpDistance(ret.inf, ret.sup) <= 1 };
+}
 
-	return value;
+template <typename Ty>
+auto BasicReferenceW<Ty>::W0(Ty x, Certificate& certificate) -> IntervalTy
+{
+	return Certified(x, certificate, 0);
 }
 
-static inline double FirstW0Approx(double x)
+template <typename Ty>
+auto BasicReferenceW<Ty>::Wm1(Ty x, Certificate& certificate) -> IntervalTy
 {
-	if (abs(x) < 1e-4)
-		return x;
+	return Certified(x, certificate, -1);
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::Certified(Ty x, Certificate& certificate, int branch) -> IntervalTy
+{
+	// W0, Wm1 and Certify restore the rounding mode themselves, also when a sign test throws
+	try
+	{
+		IntervalTy ret = (branch == 0) ? W0(x) : Wm1(x);
+		certificate = Certify(x, ret, branch);
+		return ret;
+	}
+	catch (const AmbiguousSignError&)
+	{
+		// No proof at the precisions available, report it rather than an enclosure
+		certificate = { x, NAN, NAN, Sign::Inconclusive, Sign::Inconclusive, 0, 0, branch, false };
+		return { NAN, NAN };
+	}
+}
+
+/*
+w e^w - x is continuous, so opposite signs at the ends prove a root inside. f' = e^w (w + 1) has one
+sign on either side of -1, so an enclosure on the branch's side of -1 holds exactly one root, which
+is the branch's. Sign tests at the recorded precision use the same arithmetic as the evaluation,
+so they are conclusive again.
+*/
+template <typename Ty>
+bool BasicReferenceW<Ty>::Verify(const Certificate& certificate)
+{
+	using Traits = ReferenceWTraits<Ty>;
+
+	auto [x, low, high, lowSign, highSign, lowPrec, highPrec, branch, isSpecial] = certificate;
+	if (branch != 0 && branch != -1)
+		return false;
+
+	if (isSpecial)
+	{
+		// Outside the branch's domain
+		if (std::isnan(low) && std::isnan(high))
+			return std::isnan(x) || x < Traits::EmUp || (branch == -1 && x >= 0);
+		if (branch == 0 && x == 0)
+			return low == 0 && high == 0;
+		if (branch == 0 && x == INFINITY)
+			return low == std::numeric_limits<Ty>::max() && high == INFINITY;
+		return false;
+	}
+
+	// Enclosure on the branch's side of -1, with signs which bracket the root
+	if (!(low < high) || !std::isfinite(low) || !std::isfinite(high))
+		return false;
+	if ((branch == 0) ? (low < -1) : (high > -1))
+		return false;
+	Sign lowExpected = (branch == 0) ? Sign::Negative : Sign::Positive;
+	Sign highExpected = (branch == 0) ? Sign::Positive : Sign::Negative;
+	if (lowSign != lowExpected || highSign != highExpected)
+		return false;
+
+	// The two sign tests, at the precisions that proved them
+	auto test = [&](Ty w, slong prec, Sign expected)
+	{
+		bool useHighPrec;
+		if (prec == Traits::HighSignPrec)
+			useHighPrec = true;
+		else if constexpr (Traits::HasFastSign)
+		{
+			if (prec != 0)
+				return false;
+			useHighPrec = false;
+		}
+		else if (prec == Traits::SignPrec)
+			useHighPrec = false;
+		else
+			return false;
 
-	static constexpr double P[] = {
-		0,
-		30.580056454638136,
-		83.95836185597197,
-		46.16620637664877,
-		3.4636816277252214
+		anchorPrec = 0; // Fresh exp, as in Certify
+		return GetMidpointResidual(x, w, useHighPrec).sign == expected;
 	};
 
-	static constexpr double Q[] = {
-		30.578403642151667,
-		114.49011569793561,
-		114.80618615998705,
-		28.635096582884064,
-		1
+	RoundingScope rounding;
+	fesetround(FE_TONEAREST);
+	return test(low, lowPrec, lowSign) && test(high, highPrec, highSign);
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::Certify(Ty x, const IntervalTy& enclosure, int branch) -> Certificate
+{
+	using Traits = ReferenceWTraits<Ty>;
+
+	Certificate certificate{ x, enclosure.inf, enclosure.sup, Sign::Inconclusive, Sign::Inconclusive, 0, 0, branch, false };
+	if (std::isnan(enclosure.inf) || enclosure.inf == enclosure.sup || std::isinf(enclosure.sup))
+	{
+		certificate.isSpecial = true;
+		return certificate;
+	}
+
+	// Sign test at w, escalating like GetResidual, and the precision which settled it
+	auto test = [&](Ty w, Sign& sign, slong& prec)
+	{
+		// Fresh exp rather than one reused from the search, so Verify repeats the same arithmetic
+		anchorPrec = 0;
+		Residual residual = GetMidpointResidual(x, w, false);
+		if constexpr (Traits::HasFastSign)
+			prec = 0;
+		else
+			prec = Traits::SignPrec;
+
+		if (residual.sign == Sign::Inconclusive)
+		{
+			residual = GetMidpointResidual(x, w, true);
+			prec = Traits::HighSignPrec;
+		}
+
+		// Left Inconclusive if unproven, which Verify rejects
+		sign = residual.sign;
 	};
 
-	double numer = P[4];
-	for (size_t i = 0; i < 4; i++)
-		numer = numer * x + P[3 - i];
+	RoundingScope rounding;
+	fesetround(FE_TONEAREST);
+	test(certificate.low, certificate.lowSign, certificate.lowPrec);
+	test(certificate.high, certificate.highSign, certificate.highPrec);
 
-	double denom = Q[4];
-	for (size_t i = 0; i < 4; i++)
-		denom = denom * x + Q[3 - i];
+	return certificate;
+}
 
-	return numer / denom;
+template <typename Ty>
+auto BasicReferenceW<Ty>::W0WithDerivative(Ty x) -> WithDerivative
+{
+	IntervalTy w = W0(x);
+	return { w, Derivative(x, w, 0) };
 }
 
-double SecondW0Approx(double x)
+template <typename Ty>
+auto BasicReferenceW<Ty>::Wm1WithDerivative(Ty x) -> WithDerivative
 {
-	static constexpr double P[] = {
-		64312.7454007891,
-		43264.12227598657,
-		20243.65384336377,
-		453.17656235798086,
-		1.0000432316050645
-	};
-	static constexpr double Q[] = {
-		104342.57917932322,
-		22499.368605590193,
-		460.93750724715477,
-		1
-	};
+	IntervalTy w = Wm1(x);
+	return { w, Derivative(x, w, -1) };
+}
+
+/*
+Enclosure of W'(x) from an enclosure [low, high] of W(x)
+
+W'(x) = g(W(x)) with g(w) = w / (x (1 + w)), so no exp is needed. g'(w) = 1 / (x (1 + w)^2) has
+the sign of x, so g is monotone over the enclosure and W'(x) lies between g(low) and g(high).
+Both are evaluated as points in arb and rounded outwards. g has a pole at w = -1, only reached
+by an end of an enclosure at the branch point, where W' tends to +Inf on W0 and -Inf on Wm1.
+*/
+template <typename Ty>
+auto BasicReferenceW<Ty>::Derivative(Ty x, const IntervalTy& enclosure, int branch) -> IntervalTy
+{
+	// === Parameters ===
+	static constexpr slong Prec = 64;
+	// ==================
+
+	// Edge cases
+	if (std::isnan(enclosure.inf))
+		return { NAN, NAN };
+	if (x == 0)
+		return { 1, 1 };
+	if (x == INFINITY)
+		return { 0, 0 };
+
+	RoundingScope rounding;
+	fesetround(FE_TONEAREST);
+	arb_set_d(xArb, x);
+	Ty pole = (branch == 0) ? (Ty)INFINITY : -(Ty)INFINITY;
+	IntervalTy ret = { INFINITY, -INFINITY };
+	for (Ty w : { enclosure.inf, enclosure.sup })
+	{
+		// g(w) = w / (x (1 + w))
+		arb_set_d(wArb, w);
+		arb_add_ui(derivArb, wArb, 1, Prec);
+		arb_mul(derivArb, derivArb, xArb, Prec);
+		arb_div(derivArb, wArb, derivArb, Prec);
+
+		Ty low = pole, high = pole;
+		if (arb_is_finite(derivArb))
+		{
+			arb_get_lbound_arf(boundArf, derivArb, Prec);
+			low = RoundDown<Ty>(boundArf);
+			arb_get_ubound_arf(boundArf, derivArb, Prec);
+			high = RoundUp<Ty>(boundArf);
+		}
+
+		ret.inf = std::min(ret.inf, low);
+		ret.sup = std::max(ret.sup, high);
+	}
+
+	return ret;
+}
+
+// Whether a double enclosure could be W(x) on the branch, for an x inside its domain and away from
+// the edge cases. Only cheap checks, an enclosure of the right branch at another x isn't caught.
+static bool IsBranchEnclosure(float x, const Interval& enclosure, int branch)
+{
+	if (std::isnan(x) || x < ReferenceWTraits<float>::EmUp || std::isinf(x) || x == 0 || (branch == -1 && x > 0))
+		return false;
+	if (!std::isfinite(enclosure.inf) || !std::isfinite(enclosure.sup) || enclosure.inf > enclosure.sup)
+		return false;
+
+	// W0 is above -1 with the sign of x, Wm1 below -1
+	if (branch == 0)
+		return enclosure.inf >= -1 && ((x > 0) ? enclosure.inf >= 0 : enclosure.sup <= 0);
+	return enclosure.sup <= -1;
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::W0(Ty x, const Interval& enclosure) -> IntervalTy requires std::is_same_v<Ty, float>
+{
+	// Edge cases and enclosures which can't be W0's go through a full evaluation
+	if (!IsBranchEnclosure(x, enclosure, 0))
+		return W0(x);
+
+#if REFERENCEW_STATS
+	numEvals++;
+#endif
+
+	return FromDouble(x, enclosure, true);
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::Wm1(Ty x, const Interval& enclosure) -> IntervalTy requires std::is_same_v<Ty, float>
+{
+	// Edge cases and enclosures which can't be Wm1's go through a full evaluation
+	if (!IsBranchEnclosure(x, enclosure, -1))
+		return Wm1(x);
+
+#if REFERENCEW_STATS
+	numEvals++;
+#endif
+
+	return FromDouble(x, enclosure, false);
+}
+
+template <typename Ty>
+void BasicReferenceW<Ty>::Warmup()
+{
+	// Inputs reaching every bracket and sign test path, on a throwaway evaluator so no stats are
+	// recorded against the caller's
+	static constexpr Ty EmUp = ReferenceWTraits<Ty>::EmUp;
+	static constexpr Ty W0Inputs[] = { EmUp, (Ty)-0.3, (Ty)-0.1, (Ty)-1e-3, (Ty)1e-3, 1, 5, 100, std::numeric_limits<Ty>::max() };
+	static constexpr Ty Wm1Inputs[] = { EmUp, (Ty)-0.3678, (Ty)-0.33, (Ty)-0.1, (Ty)-1e-7, -std::numeric_limits<Ty>::min() };
+
+	RoundingScope rounding;
+	BasicReferenceW evaluator;
+	for (Ty x : W0Inputs)
+		evaluator.W0(x);
+	for (Ty x : Wm1Inputs)
+		evaluator.Wm1(x);
+
+	// The high precision sign test is rarely reached from the inputs above, build its caches directly
+	// for a negative and two positive midpoints. Midpoints at or above x return before any arb call
+	static constexpr std::pair<Ty, Ty> HighPrecInputs[] = { { (Ty)-0.3, (Ty)-0.5 }, { (Ty)0.5, (Ty)0.25 }, { (Ty)100, (Ty)0.25 } };
+	for (auto [x, midpoint] : HighPrecInputs)
+		evaluator.GetMidpointResidual(x, midpoint, true);
+}
 
-	double lx = log(x);
+template <typename Ty>
+void BasicReferenceW<Ty>::ResetExpAnchor()
+{
+	anchorPrec = 0;
+}
 
-	double numer = P[4];
-	for (size_t i = 0; i < 4; i++)
-		numer = numer * lx + P[3 - i];
+#if REFERENCEW_STATS
+template <typename Ty>
+double BasicReferenceW<Ty>::GetHighPrecRate() const
+{
+	return (double)numHighPrec / totalBisections;
+}
 
-	double denom = Q[3];
-	for (size_t i = 0; i < 3; i++)
-		denom = denom * lx + Q[2 - i];
+template <typename Ty>
+size_t BasicReferenceW<Ty>::GetMaxBisections() const
+{
+	return maxBisections;
+}
 
-	return numer / denom;
+template <typename Ty>
+double BasicReferenceW<Ty>::GetAvgBisections() const
+{
+	return (double)totalBisections / numEvals;
 }
 
-std::pair<double, double> ReferenceW::W0Bracket(double x)
+template <typename Ty>
+size_t BasicReferenceW<Ty>::GetTotalBisections() const
 {
+	return totalBisections;
+}
+
+template <typename Ty>
+size_t BasicReferenceW<Ty>::GetNumHighPrec() const
+{
+	return numHighPrec;
+}
+
+template <typename Ty>
+size_t BasicReferenceW<Ty>::GetNumExpReuse() const
+{
+	return numExpReuse;
+}
+
+template <typename Ty>
+size_t BasicReferenceW<Ty>::GetNumContractions() const
+{
+	return numContractions;
+}
+#endif
+
+template <typename Ty>
+REFERENCEW_TARGET_CLONES
+std::pair<Ty, Ty> BasicReferenceW<Ty>::W0Bracket(Ty x)
+{
+	using Traits = ReferenceWTraits<Ty>;
+
 	// Initial approximation
-	double w;
+	Ty w;
 	fesetround(FE_TONEAREST);
-	if (x < -0.28)
+	if (x < Traits::W0NearBranch)
 		w = NearBranchW0(x);
 	else
 	{
-		w = (x < 7.34) ? FirstW0Approx(x) : SecondW0Approx(x);
-
-		// Fritsch Iteration
-		double zn = log(x / w) - w;
-		double temp = 1.0 + w;
-		double temp2 = temp + (2.0 / 3.0) * zn;
-		temp2 = 2.0 * temp * temp2;
-		w = w * (1.0 + (zn / temp) * (temp2 - zn) / (temp2 - 2.0 * zn));
+		w = (x < Traits::W0SecondApprox) ? FirstApproxW0(x) : SecondApproxW0(x);
+
+		// Fritsch Iteration, the float approximations are already accurate enough
+		if constexpr (std::is_same_v<Ty, double>)
+		{
+			double zn = log(x / w) - w;
+			double temp = 1.0 + w;
+			double temp2 = temp + (2.0 / 3.0) * zn;
+			temp2 = 2.0 * temp * temp2;
+			w = w * (1.0 + (zn / temp) * (temp2 - zn) / (temp2 - 2.0 * zn));
+		}
 	}
 
 	// Derivative Bound
@@ -253,19 +518,27 @@ std::pair<double, double> ReferenceW::W0Bracket(double x)
 			static constexpr double E2_DOWN = 5.43656365691809;
 			static constexpr double E2_UP = 5.436563656918091;
 
-			double etaUp = fma(E2_DOWN, x, 2, FE_UPWARD);
-			double etaDown = fma(E2_UP, x, 2, FE_DOWNWARD);
+			double etaUp = fma(E2_DOWN, (double)x, 2, FE_UPWARD);
+			double etaDown = fma(E2_UP, (double)x, 2, FE_DOWNWARD);
 			etaDown = mul(b, sqrt(etaDown, FE_DOWNWARD), FE_DOWNWARD);
 			double denom = fma(a, etaUp, etaDown, FE_DOWNWARD);
 			d = sub(div(1, denom, FE_UPWARD), 1, FE_UPWARD);
 		}
 		else
-			d = sub(mul(mul(x, x, FE_UPWARD), 3, FE_UPWARD), x, FE_UPWARD);
+			d = sub(mul(mul((double)x, (double)x, FE_UPWARD), 3, FE_UPWARD), (double)x, FE_UPWARD);
 	}
 
 	// Del Bound
 	double del;
-	if (x > 4.11380962917)
+	if constexpr (std::is_same_v<Ty, float>)
+	{
+		// Float approximations are far from double precision, so a double enclosure suffices
+		auto [expDown, expUp] = ExpUpDown((double)w);
+		double delDown = mul(div((double)w, (double)x, FE_DOWNWARD), expDown, FE_DOWNWARD);
+		double delUp = mul(div((double)w, (double)x, FE_UPWARD), expUp, FE_UPWARD);
+		del = std::max(abs(delDown - 1), abs(delUp - 1));
+	}
+	else if (x > 4.11380962917)
 	{
 		static constexpr double N = 50;
 		static constexpr double EN_DOWN = 5.184705528587072e+21;
@@ -307,90 +580,56 @@ std::pair<double, double> ReferenceW::W0Bracket(double x)
 	}
 
 	// Compute final error
-	double err = mul(d, del, FE_UPWARD);
-	double low = sub(w, err, FE_DOWNWARD);
-	double high = add(w, err, FE_UPWARD);
-	high = std::max(high, -1.0);
+	Ty err = mul(d, del, FE_UPWARD);
+	Ty low = sub(w, err, FE_DOWNWARD);
+	Ty high = add(w, err, FE_UPWARD);
+	high = std::max(high, (Ty)-1);
+
+	if (low == 0) low = 0;
 
 	return { low, high };
 }
 
-static inline double NearBranchWm1(double x)
+template <typename Ty>
+REFERENCEW_TARGET_CLONES
+std::pair<Ty, Ty> BasicReferenceW<Ty>::Wm1Bracket(Ty x)
 {
-	// === Constants ===
-	static constexpr double s2e = 2.331643981597124;
-	static constexpr double P[] = {
-		-0.9999999999999999,
-		-1.0000000000001505,
-		-0.3333333333112154,
-		-0.15277777908701176,
-		-0.07962958804769303,
-		-0.0445031235579835,
-		-0.02597432503406348,
-		-0.015728030108091574,
-		-0.009031309914783386,
-		-0.008702394675700187,
-		0.005169843845676331,
-		-0.02414898256188974,
-		0.03559281100127844,
-		-0.044160933247669634,
-		0.030269166389388674,
-		-0.011279992858844562
-	};
-	// =================
-
-	double p = sqrt(AddEm(x)) * s2e;
-	double w = P[15];
-	for (size_t i = 0; i < 15; i++)
-		w = w * p + P[14 - i];
+	using Traits = ReferenceWTraits<Ty>;
 
-	return w;
-}
-
-std::pair<double, double> ReferenceW::Wm1Bracket(double x)
-{
 	// === Constants ===
 	static constexpr double C23_DOWN = 0.6666666666666666;
 	static constexpr double C23_UP = 0.6666666666666667;
 	static constexpr double N = 50;
 	static constexpr double EN_DOWN = 5.184705528587072e+21;
 	static constexpr double EN_UP = 5.184705528587073e+21;
-	static constexpr double P[] = {
-		0,
-		-5.415413805902706,
-		-2.787876451002007,
-		-0.4992978139443087
-	};
-	static constexpr double Q = 5.410664283026123;
 	// =================
 
-	double w;
+	Ty w;
 	fesetround(FE_TONEAREST);
-	if (x < -0.318092372804)
+	if (x < Traits::Wm1NearBranch)
 		w = NearBranchWm1(x);
 	else
 	{
 		// Initial approximation
-		double t = sqrt(-2 - 2 * log(-x));
-		w = P[3];
-		for (size_t i = 0; i < 3; i++)
-			w = w * t + P[2 - i];
-		w = w / (t + Q) - 1.0;
-
-		// Fritsch Iteration
-		double zn;
-		if (x > -1e-300)
-			zn = log((x * 4611686018427387904.0) / w) - 42.975125194716609184 - w;
-		else
-			zn = log(x / w) - w;
-		double temp = 1.0 + w;
-		double temp2 = temp + (2.0 / 3.0) * zn;
-		temp2 = 2.0 * temp * temp2;
-		w = w * (1.0 + (zn / temp) * (temp2 - zn) / (temp2 - 2.0 * zn));
+		w = GeneralWm1(x);
+
+		// Fritsch Iteration, the float approximations are already accurate enough
+		if constexpr (std::is_same_v<Ty, double>)
+		{
+			double zn;
+			if (x > -1e-300)
+				zn = log((x * 4611686018427387904.0) / w) - 42.975125194716609184 - w;
+			else
+				zn = log(x / w) - w;
+			double temp = 1.0 + w;
+			double temp2 = temp + (2.0 / 3.0) * zn;
+			temp2 = 2.0 * temp * temp2;
+			w = w * (1.0 + (zn / temp) * (temp2 - zn) / (temp2 - 2.0 * zn));
+		}
 	}
 
 	// Derivative Bound
-	double logUp = std::nextafter(Sleef_log_u10(-x), INFINITY);
+	double logUp = std::nextafter(Sleef_log_u10(-(double)x), INFINITY);
 	double rtDown = sqrt(sub(-2, mul(logUp, 2, FE_UPWARD), FE_DOWNWARD), FE_DOWNWARD);
 	double denom = add(sub(C23_UP, rtDown, FE_UPWARD), mul(logUp, C23_DOWN, FE_UPWARD), FE_UPWARD);
 	double d = sub(1, div(1.0, denom, FE_DOWNWARD), FE_UPWARD);
@@ -398,7 +637,15 @@ std::pair<double, double> ReferenceW::Wm1Bracket(double x)
 
 	// Del Bound
 	double del;
-	if (x > -0.00000137095397731)
+	if constexpr (std::is_same_v<Ty, float>)
+	{
+		// Float approximations are far from double precision, so a double enclosure suffices
+		auto [expDown, expUp] = ExpUpDown((double)w);
+		double delDown = mul(div((double)w, (double)x, FE_DOWNWARD), expDown, FE_DOWNWARD);
+		double delUp = mul(div((double)w, (double)x, FE_UPWARD), expUp, FE_UPWARD);
+		del = std::max(abs(delDown - 1), abs(delUp - 1));
+	}
+	else if (x > -0.00000137095397731)
 	{
 		double expDown = add(w, N, FE_DOWNWARD);
 		double expUp = add(w, N, FE_UPWARD);
@@ -428,43 +675,169 @@ std::pair<double, double> ReferenceW::Wm1Bracket(double x)
 	}
 
 	// Compute final error
-	double err = mul(d, del, FE_UPWARD);
-	double low = sub(w, err, FE_DOWNWARD);
-	double high = add(w, err, FE_UPWARD);
-	high = std::min(high, -1.0);
+	Ty err = mul(d, del, FE_UPWARD);
+	Ty low = sub(w, err, FE_DOWNWARD);
+	Ty high = add(w, err, FE_UPWARD);
+	high = std::min(high, (Ty)-1);
 
 	return { low, high };
 }
 
-Sign ReferenceW::GetMidpointSign(double x, double midpoint, bool useHighPrec)
+/*
+yArb = exp(mArb), reusing the enclosure of exp at an earlier point a: exp(m) = exp(a) exp(m - a)
+
+Sign test points only move by a shrinking fraction of the bracket, so |m - a| is tiny and
+exp(m - a) only needs a few terms of its Taylor series, see ExpShifted. The anchor is replaced with
+a full arb_exp when m is too far from it, so errors never compound across reuses. Only called at
+SignPrec for double, by its sign tests and Newton's f(c). Float sign tests start from a double
+enclosure and the high precision ones are too rare to benefit, so the anchor is never set for float.
+*/
+template <typename Ty>
+void BasicReferenceW<Ty>::Exp(slong prec)
+{
+	// === Parameters ===
+	static constexpr slong MaxReuseExp = -16; // Reuse while |m - a| < 2^MaxReuseExp
+	// ==================
+
+	if (anchorPrec == prec)
+	{
+		arb_sub(dArb, mArb, anchorArb, prec);
+		arb_get_mag(errMag, dArb);
+		if (mag_cmp_2exp_si(errMag, MaxReuseExp) < 0)
+		{
+			ExpShifted(yArb, anchorExpArb, dArb, MaxReuseExp, prec, seriesArb, errMag);
+
+#if REFERENCEW_STATS
+			numExpReuse++;
+#endif
+			return;
+		}
+	}
+
+	arb_exp(yArb, mArb, prec);
+	arb_set(anchorArb, mArb);
+	arb_set(anchorExpArb, yArb);
+	anchorPrec = prec;
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::GetMidpointResidual(Ty x, Ty midpoint, bool useHighPrec) -> Residual
 {
+	using Traits = ReferenceWTraits<Ty>;
+
 #if REFERENCEW_STATS
 	if (useHighPrec)
 		numHighPrec++;
 #endif
 
 	if (midpoint >= x)
-		return Sign::Positive;
-	slong prec = useHighPrec ? 150 : 90;
+		return { Sign::Positive, NAN };
+
+	if constexpr (Traits::HasFastSign)
+	{
+		if (!useHighPrec)
+		{
+			double m = midpoint;
+
+			// Compute exp
+			auto [yLow, yHigh] = ExpUpDown(m);
+			if (midpoint < 0)
+				std::swap(yLow, yHigh);
+
+			// Compute yLow
+			yLow = mul(yLow, m, FE_DOWNWARD);
+			yLow = sub(yLow, (double)x, FE_DOWNWARD);
+
+			// Compute yHigh
+			yHigh = mul(yHigh, m, FE_UPWARD);
+			yHigh = sub(yHigh, (double)x, FE_UPWARD);
+
+			double value = std::midpoint(yLow, yHigh);
+			if (yLow >= 0 && yHigh >= 0)
+				return { Sign::Positive, value };
+			if (yLow <= 0 && yHigh <= 0)
+				return { Sign::Negative, value };
+
+			return { Sign::Inconclusive, value };
+		}
+	}
+
+	slong prec;
+	if constexpr (Traits::HasFastSign)
+		prec = Traits::HighSignPrec;
+	else
+		prec = useHighPrec ? Traits::HighSignPrec : Traits::SignPrec;
 
 	arb_set_d(xArb, x);
 	arb_set_d(mArb, midpoint);
-	arb_exp(yArb, mArb, prec);
+	if (!Traits::HasFastSign && !useHighPrec)
+		Exp(prec);
+	else
+		arb_exp(yArb, mArb, prec);
 	arb_mul(yArb, yArb, mArb, prec);
 	arb_sub(yArb, yArb, xArb, prec);
 
 	bool isPos = arb_is_nonnegative(yArb);
 	bool isNeg = arb_is_nonpositive(yArb);
+	double value = arf_get_d(arb_midref(yArb), ARF_RND_NEAR);
 
 	if (isPos)
-		return Sign::Positive;
+		return { Sign::Positive, value };
 	if (isNeg)
-		return Sign::Negative;
+		return { Sign::Negative, value };
 
-	return Sign::Inconclusive;
+	return { Sign::Inconclusive, value };
 }
 
-Interval ReferenceW::Bisection(double x, double low, double high, bool increasing)
+// Charges one sign test or Newton contraction to the budget, false if it is exhausted
+template <typename Ty>
+bool BasicReferenceW<Ty>::Spend()
+{
+	if (!budget)
+		return true;
+	if (numSignTests >= budget->maxSignTests)
+		return false;
+	if (budget->deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= budget->deadline)
+		return false;
+
+	numSignTests++;
+	return true;
+}
+
+// Conclusive residual at w, escalating to high precision when needed. Inconclusive only if the
+// budget is exhausted.
+template <typename Ty>
+auto BasicReferenceW<Ty>::GetResidual(Ty x, Ty w) -> Residual
+{
+	if (!Spend())
+		return { Sign::Inconclusive, NAN };
+
+	Residual residual = GetMidpointResidual(x, w, false);
+	if (residual.sign == Sign::Inconclusive)
+	{
+		if (budget && !budget->allowHighPrec)
+			return residual;
+		residual = GetMidpointResidual(x, w, true);
+	}
+
+	if (residual.sign == Sign::Inconclusive)
+		throw AmbiguousSignError(std::format("Ambiguous sign: {}", x));
+
+	return residual;
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::Search(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps) -> IntervalTy
+{
+	if (method == SearchMethod::Illinois)
+		return Illinois(x, low, high, increasing, maxUlps);
+	if (method == SearchMethod::Newton)
+		return Newton(x, low, high, increasing, maxUlps);
+	return Bisection(x, low, high, increasing, maxUlps);
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::Bisection(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps) -> IntervalTy
 {
 #if REFERENCEW_STATS
 	size_t b = 0;
@@ -477,22 +850,16 @@ Interval ReferenceW::Bisection(double x, double low, double high, bool increasin
 		b++;
 #endif
 
-		if (high <= std::nextafter(low, INFINITY))
-			break; // Bracket cannot be narrowed any further
+		if (UlpDistance(low, high) <= maxUlps)
+			break; // Bracket is narrow enough
 
 		// m = (low + high) / 2
-		double m = std::midpoint(low, high);
+		Ty m = std::midpoint(low, high);
 
 		// Calculate midpoint sign
-		Sign sign = GetMidpointSign(x, m, false);
+		Sign sign = GetResidual(x, m).sign;
 		if (sign == Sign::Inconclusive)
-			sign = GetMidpointSign(x, m, true);
-
-		if (sign == Sign::Inconclusive)
-		{
-			std::cerr << std::format("Error, ambiguous sign: {}\n", x);
-			throw;
-		}
+			break; // Out of budget
 
 		// Update bracket
 		if ((sign == Sign::Positive) == increasing)
@@ -507,4 +874,187 @@ Interval ReferenceW::Bisection(double x, double low, double high, bool increasin
 #endif
 
 	return { low, high };
-}
\ No newline at end of file
+}
+
+/*
+Regula falsi in ordered ulp space, with the Illinois modification
+
+The residual values from the sign tests at the bracket ends place the next point by linear
+interpolation, which lands within a few ulps of the root as w e^w - x is close to linear over a
+bracket. The point is clamped strictly inside the bracket in ordered integers, so every step makes
+progress. When an end is kept twice in a row its residual is halved, which stops the other end from
+creeping one ulp at a time, and a step which fails to halve the bracket forces a bisection of the
+ordered integers next, bounding the worst case to about twice that of bisection.
+*/
+template <typename Ty>
+auto BasicReferenceW<Ty>::Illinois(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps) -> IntervalTy
+{
+#if REFERENCEW_STATS
+	size_t b = 0;
+#endif
+
+	fesetround(FE_TONEAREST);
+
+	// Widths are unsigned, a bracket across zero may span more than half the ordered range
+	using Width = std::make_unsigned_t<OrderedInt<Ty>>;
+	OrderedInt<Ty> lo = ToOrdered(low), hi = ToOrdered(high);
+	Width prevWidth = (Width)hi - (Width)lo;
+
+	// Residuals at the ends, oriented to be negative at lo and positive at hi, NaN until tested
+	double gLo = NAN, gHi = NAN;
+	int lastMoved = 0; // -1 if lo moved last, 1 if hi did
+	bool forceBisection = false;
+
+	for (;;)
+	{
+#if REFERENCEW_STATS
+		b++;
+#endif
+
+		Width width = (Width)hi - (Width)lo;
+		if (width <= maxUlps)
+			break; // Bracket is narrow enough
+
+		// Next point, interpolated if both end residuals are known
+		OrderedInt<Ty> mo = (OrderedInt<Ty>)((Width)lo + width / 2);
+		bool isSecant = false;
+		if (!forceBisection && std::isfinite(gLo) && std::isfinite(gHi))
+		{
+			double t = gLo / (gLo - gHi);
+			if (t >= 0 && t <= 1)
+			{
+				double wLo = FromOrdered<Ty>(lo);
+				double wHi = FromOrdered<Ty>(hi);
+				mo = std::clamp(ToOrdered((Ty)(wLo + t * (wHi - wLo))), (OrderedInt<Ty>)(lo + 1), (OrderedInt<Ty>)(hi - 1));
+				isSecant = true;
+			}
+		}
+
+		Residual residual = GetResidual(x, FromOrdered<Ty>(mo));
+		if (residual.sign == Sign::Inconclusive)
+			break; // Out of budget
+		double g = increasing ? residual.value : -residual.value;
+
+		// Update bracket, halving the residual of an end kept twice in a row
+		if ((residual.sign == Sign::Positive) == increasing)
+		{
+			hi = mo;
+			gHi = g;
+			if (lastMoved == 1)
+				gLo /= 2;
+			lastMoved = 1;
+		}
+		else
+		{
+			lo = mo;
+			gLo = g;
+			if (lastMoved == -1)
+				gHi /= 2;
+			lastMoved = -1;
+		}
+
+		// An interpolation step which didn't halve the bracket is followed by a bisection
+		Width newWidth = (Width)hi - (Width)lo;
+		forceBisection = isSecant && newWidth > prevWidth / 2;
+		prevWidth = newWidth;
+	}
+
+#if REFERENCEW_STATS
+	maxBisections = std::max(maxBisections, b);
+	totalBisections += b;
+#endif
+
+	return { FromOrdered<Ty>(lo), FromOrdered<Ty>(hi) };
+}
+
+/*
+Interval Newton on f(w) = w e^w - x
+
+Every root of f in W lies in N(W) = c - f(c) / f'(W), where c is a point of W and f'(W) = e^W (W + 1)
+encloses the derivative over W. The bracket is already a rigorous enclosure of the root, so
+intersecting it with N(W) only tightens it. Each contraction roughly squares the relative width,
+so the bracket is usually 1ulp after one or two, with an exp of W and of c for each. Whatever is left,
+including brackets near the branch point where f'(W) contains zero, is finished by bisection.
+*/
+template <typename Ty>
+auto BasicReferenceW<Ty>::Newton(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps) -> IntervalTy
+{
+	using Traits = ReferenceWTraits<Ty>;
+
+	// === Parameters ===
+	static constexpr size_t MaxContractions = 2;
+	// ==================
+
+	slong prec;
+	if constexpr (Traits::HasFastSign)
+		prec = Traits::HighSignPrec;
+	else
+		prec = Traits::SignPrec;
+
+	fesetround(FE_TONEAREST);
+	arb_set_d(xArb, x);
+	for (size_t i = 0; i < MaxContractions; i++)
+	{
+		if (UlpDistance(low, high) <= maxUlps || !Spend())
+			break;
+
+#if REFERENCEW_STATS
+		numContractions++;
+#endif
+
+		// f'(W)
+		arb_set_d(wArb, low);
+		arb_set_d(yArb, high);
+		arb_union(wArb, wArb, yArb, prec);
+		arb_exp(derivArb, wArb, prec);
+		arb_add_ui(yArb, wArb, 1, prec);
+		arb_mul(derivArb, derivArb, yArb, prec);
+		if (arb_contains_zero(derivArb))
+			break;
+
+		// f(c), sharing the sign tests' exp anchor for double
+		Ty c = std::midpoint(low, high);
+		arb_set_d(mArb, c);
+		if constexpr (Traits::HasFastSign)
+			arb_exp(yArb, mArb, prec);
+		else
+			Exp(prec);
+		arb_mul(yArb, yArb, mArb, prec);
+		arb_sub(yArb, yArb, xArb, prec);
+
+		// N(W) = c - f(c) / f'(W)
+		arb_div(yArb, yArb, derivArb, prec);
+		arb_sub(yArb, mArb, yArb, prec);
+		if (!arb_is_finite(yArb))
+			break;
+
+		arb_get_lbound_arf(boundArf, yArb, prec);
+		Ty newLow = std::max(low, RoundDown<Ty>(boundArf));
+		arb_get_ubound_arf(boundArf, yArb, prec);
+		Ty newHigh = std::min(high, RoundUp<Ty>(boundArf));
+		if (newLow > newHigh)
+			break; // Can't happen with a valid bracket, leave it to bisection
+
+		low = newLow;
+		high = newHigh;
+	}
+
+	// Only runs sign tests if [low, high] is still too wide
+	return Bisection(x, low, high, increasing, maxUlps);
+}
+
+template <typename Ty>
+auto BasicReferenceW<Ty>::FromDouble(Ty x, const Interval& enclosure, bool increasing) -> IntervalTy requires std::is_same_v<Ty, float>
+{
+	RoundingScope rounding;
+
+	// Round outwards to float
+	float low = narrow(enclosure.inf, FE_DOWNWARD);
+	float high = narrow(enclosure.sup, FE_UPWARD);
+
+	// Only runs sign tests if [low, high] is wider than 1ulp, which a 1ulp double enclosure never is
+	return Search(x, low, high, increasing, 1);
+}
+
+template class BasicReferenceW<double>;
+template class BasicReferenceW<float>;
@@ -1,35 +1,207 @@
 #pragma once
+#include <cstdint>
+#include <cfenv>
 #include <utility>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
 
 #include <arb.h>
 
 #include "Interval.h"
 #include "Sign.h"
 
-class ReferenceW
+// How the bracket is narrowed to 1ulp
+enum class SearchMethod
+{
+	Bisection,	// Halves the bracket with every sign test
+	Illinois,	// Regula falsi on the residuals at the bracket ends, safeguarded by bisection
+	Newton		// Interval Newton contractions of the bracket, then bisection of what remains
+};
+
+// Thrown when a sign test is inconclusive even at the high precision, which the precisions are
+// chosen to rule out
+struct AmbiguousSignError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+// Evaluator for float and double. Per type constants, precisions and sign test paths come from
+// ReferenceWTraits in ReferenceWTraits.h, so a new format needs its traits, its approximations in
+// approx.h and an explicit instantiation in ReferenceW.cpp. Members are only defined in ReferenceW.cpp.
+template <typename Ty>
+class BasicReferenceW
 {
 public:
-	ReferenceW();
-	~ReferenceW();
+	using IntervalTy = BasicInterval<Ty>;
+
+	// Limits on the sign tests of one evaluation, the search stops at the first one exceeded
+	struct Budget
+	{
+		size_t maxSignTests = SIZE_MAX; // A Newton contraction counts as one
+		bool allowHighPrec = true; // Otherwise stops at a sign test needing the high precision path
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+	};
+
+	// Rigorous enclosure from a budgeted evaluation, which is only 1ulp if isTight
+	struct Partial
+	{
+		IntervalTy enclosure;
+		bool isTight;
+	};
+
+	// Proof that [low, high] encloses W(x) on the given branch: the signs of w e^w - x at both
+	// ends, each with the arb precision which proved it (0 for the double enclosure used by float).
+	// Special certificates are edge cases whose result is fixed and has no sign tests.
+	struct Certificate
+	{
+		Ty x, low, high;
+		Sign lowSign, highSign;
+		slong lowPrec, highPrec;
+		int branch; // 0 or -1
+		bool isSpecial;
+	};
+
+	// Enclosures of W(x) and of W'(x) = W / (x (1 + W))
+	struct WithDerivative
+	{
+		IntervalTy w, derivative;
+	};
+
+	explicit BasicReferenceW(SearchMethod method_ = SearchMethod::Bisection);
+	~BasicReferenceW();
+
+	// Passed as maxUlps, returns the certified bracket without any sign tests
+	static constexpr size_t BracketOnly = SIZE_MAX;
+
+	// Enclosures at most maxUlps wide, 1ulp by default. Sign tests stop as soon as the bracket is
+	// narrow enough, so wider enclosures skip the final steps, which are the most likely to need
+	// the high precision sign test.
+	IntervalTy W0(Ty x, size_t maxUlps = 1);
+	IntervalTy Wm1(Ty x, size_t maxUlps = 1);
+
+	// 1ulp enclosures within a budget, or the bracket narrowed so far if it runs out. Refine
+	// continues narrowing a partial enclosure of either branch, e.g. later or on another evaluator.
+	Partial W0(Ty x, const Budget& budget);
+	Partial Wm1(Ty x, const Budget& budget);
+	Partial Refine(Ty x, const Partial& partial, const Budget& budget = {});
+
+	// 1ulp enclosures along with a certificate, which Verify checks with two sign tests and no
+	// bracket, at the precisions recorded in it. If a sign can't be proven the certificate is left
+	// unproven, with Inconclusive signs which never verify, rather than throwing.
+	IntervalTy W0(Ty x, Certificate& certificate);
+	IntervalTy Wm1(Ty x, Certificate& certificate);
+	bool Verify(const Certificate& certificate);
+
+	// 1ulp enclosures of W along with an enclosure of its derivative, which only costs a few arb
+	// operations at the ends of the W enclosure. The derivative enclosure is unbounded at the
+	// branch point, and exactly {1, 1} for W0 at 0.
+	WithDerivative W0WithDerivative(Ty x);
+	WithDerivative Wm1WithDerivative(Ty x);
 
-	Interval W0(double x);
-	Interval Wm1(double x);
+	// Derive the result from a double enclosure of the same branch at (double)x, i.e. the output
+	// of ReferenceW::W0 / ReferenceW::Wm1. A 1ulp double enclosure always narrows to at most 1ulp of
+	// float, so sign tests only run for wider ones, e.g. a Partial's. Edge cases of x, and
+	// enclosures which can't be the branch's, fall back to a full evaluation.
+	IntervalTy W0(Ty x, const Interval& enclosure) requires std::is_same_v<Ty, float>;
+	IntervalTy Wm1(Ty x, const Interval& enclosure) requires std::is_same_v<Ty, float>;
+
+	// Builds the state evaluations otherwise create lazily on first use: FLINT's constant and exp
+	// caches at the sign test precisions, and sleef's tables. FLINT's caches are thread local, so
+	// this should be called once on each thread which will evaluate.
+	static void Warmup();
+
+	// Forgets the exp enclosure kept for nearby sign tests, so the next evaluation costs what it
+	// would after an unrelated one, e.g. to time repeats of the same input
+	void ResetExpAnchor();
 
 #if REFERENCEW_STATS
 	double GetHighPrecRate() const;
 	size_t GetMaxBisections() const;
 	double GetAvgBisections() const;
+	size_t GetTotalBisections() const;
+	size_t GetNumHighPrec() const;
+	size_t GetNumExpReuse() const;
+	size_t GetNumContractions() const;
 #endif
 
 private:
+	// Sign of w e^w - x, and its value where the sign test computed one (NaN otherwise)
+	struct Residual
+	{
+		Sign sign;
+		double value;
+	};
+
+	SearchMethod method;
 	arb_t xArb, mArb, yArb;
 
+	// Budget of the current evaluation, nullptr if unlimited
+	const Budget* budget = nullptr;
+	size_t numSignTests = 0; // Spent against budget
+
+	// Sets the budget for its lifetime, so it is cleared even if a sign test throws
+	struct BudgetScope
+	{
+		BudgetScope(BasicReferenceW& evaluator_, const Budget& budget)
+			: evaluator(evaluator_)
+		{
+			evaluator.budget = &budget;
+			evaluator.numSignTests = 0;
+		}
+
+		~BudgetScope()
+		{
+			evaluator.budget = nullptr;
+		}
+
+		BasicReferenceW& evaluator;
+	};
+
+	// Restores the caller's rounding mode when it ends, so it is restored even if a sign test throws
+	struct RoundingScope
+	{
+		RoundingScope()
+			: initialRnd(fegetround())
+		{
+		}
+
+		~RoundingScope()
+		{
+			fesetround(initialRnd);
+		}
+
+		int initialRnd;
+	};
+
+	// Enclosure of exp at an earlier sign test point, reused by nearby ones
+	arb_t anchorArb, anchorExpArb, dArb, seriesArb;
+	mag_t errMag;
+	slong anchorPrec = 0; // 0 if there is no anchor
+
+	// Interval Newton
+	arb_t wArb, derivArb;
+	arf_t boundArf;
+
 #if REFERENCEW_STATS
-	size_t numEvals = 0, numHighPrec = 0, maxBisections = 0, totalBisections = 0;
+	size_t numEvals = 0, numHighPrec = 0, maxBisections = 0, totalBisections = 0, numExpReuse = 0, numContractions = 0;
 #endif
 
-	std::pair<double, double> W0Bracket(double x);
-	std::pair<double, double> Wm1Bracket(double x);
-	Sign GetMidpointSign(double x, double midpoint, bool useHighPrec);
-	Interval Bisection(double x, double low, double high, bool increasing);
-};
\ No newline at end of file
+	std::pair<Ty, Ty> W0Bracket(Ty x);
+	std::pair<Ty, Ty> Wm1Bracket(Ty x);
+	void Exp(slong prec);
+	Residual GetMidpointResidual(Ty x, Ty midpoint, bool useHighPrec);
+	bool Spend();
+	Residual GetResidual(Ty x, Ty w);
+	IntervalTy Certified(Ty x, Certificate& certificate, int branch);
+	Certificate Certify(Ty x, const IntervalTy& enclosure, int branch);
+	IntervalTy Derivative(Ty x, const IntervalTy& enclosure, int branch);
+	IntervalTy Bisection(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps);
+	IntervalTy Illinois(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps);
+	IntervalTy Newton(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps);
+	IntervalTy Search(Ty x, Ty low, Ty high, bool increasing, size_t maxUlps);
+	IntervalTy FromDouble(Ty x, const Interval& enclosure, bool increasing) requires std::is_same_v<Ty, float>;
+};
+
+using ReferenceW = BasicReferenceW<double>;
+using ReferenceWf = BasicReferenceW<float>;
@@ -0,0 +1,38 @@
+#pragma once
+#include <arb.h>
+
+// Per type constants of BasicReferenceW, shared with the baseline engines so they agree on the
+// domain and the approximation used as a starting point
+template <typename Ty>
+struct ReferenceWTraits;
+
+template <>
+struct ReferenceWTraits<double>
+{
+	static constexpr double EmUp = -0.3678794411714423; // (-1/e) rounded towards +Inf
+
+	// Approximation thresholds
+	static constexpr double W0NearBranch = -0.28;
+	static constexpr double W0SecondApprox = 7.34;
+	static constexpr double Wm1NearBranch = -0.318092372804;
+
+	// Sign tests, all in arb
+	static constexpr bool HasFastSign = false;
+	static constexpr slong SignPrec = 90;
+	static constexpr slong HighSignPrec = 150;
+};
+
+template <>
+struct ReferenceWTraits<float>
+{
+	static constexpr float EmUp = -0.36787942f; // (-1/e) rounded towards +Inf
+
+	// Approximation thresholds
+	static constexpr float W0NearBranch = -0.3f;
+	static constexpr float W0SecondApprox = 7.38905609893f;
+	static constexpr float Wm1NearBranch = -0.367877785718f;
+
+	// Sign tests, a double enclosure first then arb
+	static constexpr bool HasFastSign = true;
+	static constexpr slong HighSignPrec = 70;
+};
@@ -0,0 +1,311 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+/*
+Initial approximations used to seed the brackets, shared by ReferenceW and ReferenceWf and exposed
+so they can be benchmarked on their own. None of these are rigorous, the brackets bound their error.
+*/
+
+// === float ===
+inline float AddEm(float x)
+{
+	static constexpr float emHigh = 0.36787945f;
+	static constexpr float emLow = -9.149756e-09f;
+	return (x + emHigh) + emLow;
+}
+
+inline float NearBranchW0(float x)
+{
+	static constexpr double e2 = 5.43656365691809;
+
+	static constexpr double P[] = {
+		-0.9999999781289544,
+		0.9999966080647236,
+		-0.33324531164727067,
+		0.15189891604646868,
+		-0.07530393941472714,
+		0.03290035332102544,
+		-0.008369773627101843
+	};
+
+	double p = std::sqrt(e2 * x + 2.0);
+
+	double res = P[6];
+	for (size_t i = 0; i < 6; i++)
+		res = res * p + P[5 - i];
+
+	return res;
+}
+
+inline float FirstApproxW0(float x)
+{
+	static constexpr double P[] = {
+		0,
+		165.51561672164559,
+		1104.9153130867758,
+		2632.284078577963,
+		2689.464120405435,
+		1121.2923665114324,
+		153.3374641092571,
+		4.077322829553558
+	};
+
+	static constexpr double Q[] = {
+		165.51561558818844,
+		1270.4310030077481,
+		3654.442208397931,
+		4879.631928655197,
+		3045.0058891120098,
+		794.8712729472717,
+		67.22857835896016,
+		1
+	};
+
+	double numer = P[7];
+	for (size_t i = 0; i < 7; i++)
+		numer = numer * x + P[6 - i];
+
+	double denom = Q[7];
+	for (size_t i = 0; i < 7; i++)
+		denom = denom * x + Q[6 - i];
+
+	return numer / denom;
+}
+
+inline float SecondApproxW0(float x)
+{
+	static constexpr double P[] = {
+		245182.20097823755,
+		280243.5212428723,
+		142843.813324628,
+		40353.72076097795,
+		5776.914448840662,
+		184.83613670644033,
+		0.9984483567344636
+	};
+
+	static constexpr double Q[] = {
+		432788.26007218857,
+		216948.13159273885,
+		58081.26591912717,
+		6594.751582203545,
+		191.21022696372594,
+		1
+	};
+
+	double t = std::log((double)x);
+
+	double numer = P[6];
+	for (size_t i = 0; i < 6; i++)
+		numer = numer * t + P[5 - i];
+
+	double denom = Q[5];
+	for (size_t i = 0; i < 5; i++)
+		denom = denom * t + Q[4 - i];
+
+	return numer / denom;
+}
+
+inline float NearBranchWm1(float x)
+{
+	static constexpr float s2e = 2.331644f;
+
+	float p = s2e * std::sqrt((double)AddEm(x));
+
+	static constexpr float P[] = {
+		-1.0000000001291165,
+		-0.9999992250595189,
+		-0.3340219624089988
+	};
+
+	float res = P[2];
+	for (size_t i = 0; i < 2; i++)
+		res = res * p + P[1 - i];
+
+	return res;
+}
+
+inline float GeneralWm1(float x)
+{
+	static constexpr double P[] = {
+		-2101.555169658076,
+		-3413.0457024602106,
+		-2345.4071921263444,
+		-864.1804177336671,
+		-175.99964384176346,
+		-17.64071303855079,
+		-0.4998769261313046
+	};
+
+	static constexpr double Q[] = {
+		2101.5551872949245,
+		1311.4898275251383,
+		333.4030604186147,
+		35.228646667156625,
+		1
+	};
+
+	double t = std::sqrt(-2 - 2 * std::log((double)-x));
+
+	double numer = P[6];
+	for (size_t i = 0; i < 6; i++)
+		numer = numer * t + P[5 - i];
+
+	double denom = Q[4];
+	for (size_t i = 0; i < 4; i++)
+		denom = denom * t + Q[3 - i];
+
+	return numer / denom;
+}
+
+// === double ===
+inline double AddEm(double x)
+{
+	static constexpr double emHigh = 0.36787944117144232160;
+	static constexpr double emLow = -1.2428753672788363168e-17;
+
+	return (x + emHigh) + emLow;
+}
+
+inline double NearBranchW0(double x)
+{
+	static constexpr double s2e = 2.331643981597124;
+	static constexpr double P[] = {
+		-1.00000000000000000000,
+		0.99999999999998689937,
+		-0.33333333333171155655,
+		0.15277777769847986078,
+		-0.07962962759798784818,
+		0.04450228328389740917,
+		-0.02598439214142129680,
+		0.01563333375832150554,
+		-0.00960508856297833703,
+		0.00596982547465134492,
+		-0.00368441824865070513,
+		0.00216878673408957843,
+		-0.00113330227139719539,
+		0.00047252681627728467,
+		-0.00013420111092875102,
+		0.00001887878365359131,
+	};
+
+	double p = std::sqrt(AddEm(x)) * s2e;
+
+	double value = P[15];
+	for (size_t i = 0; i < 15; i++)
+		value = value * p + P[14 - i];
+
+	return value;
+}
+
+inline double FirstApproxW0(double x)
+{
+	if (std::abs(x) < 1e-4)
+		return x;
+
+	static constexpr double P[] = {
+		0,
+		30.580056454638136,
+		83.95836185597197,
+		46.16620637664877,
+		3.4636816277252214
+	};
+
+	static constexpr double Q[] = {
+		30.578403642151667,
+		114.49011569793561,
+		114.80618615998705,
+		28.635096582884064,
+		1
+	};
+
+	double numer = P[4];
+	for (size_t i = 0; i < 4; i++)
+		numer = numer * x + P[3 - i];
+
+	double denom = Q[4];
+	for (size_t i = 0; i < 4; i++)
+		denom = denom * x + Q[3 - i];
+
+	return numer / denom;
+}
+
+inline double SecondApproxW0(double x)
+{
+	static constexpr double P[] = {
+		64312.7454007891,
+		43264.12227598657,
+		20243.65384336377,
+		453.17656235798086,
+		1.0000432316050645
+	};
+	static constexpr double Q[] = {
+		104342.57917932322,
+		22499.368605590193,
+		460.93750724715477,
+		1
+	};
+
+	double lx = std::log(x);
+
+	double numer = P[4];
+	for (size_t i = 0; i < 4; i++)
+		numer = numer * lx + P[3 - i];
+
+	double denom = Q[3];
+	for (size_t i = 0; i < 3; i++)
+		denom = denom * lx + Q[2 - i];
+
+	return numer / denom;
+}
+
+inline double NearBranchWm1(double x)
+{
+	// === Constants ===
+	static constexpr double s2e = 2.331643981597124;
+	static constexpr double P[] = {
+		-0.9999999999999999,
+		-1.0000000000001505,
+		-0.3333333333112154,
+		-0.15277777908701176,
+		-0.07962958804769303,
+		-0.0445031235579835,
+		-0.02597432503406348,
+		-0.015728030108091574,
+		-0.009031309914783386,
+		-0.008702394675700187,
+		0.005169843845676331,
+		-0.02414898256188974,
+		0.03559281100127844,
+		-0.044160933247669634,
+		0.030269166389388674,
+		-0.011279992858844562
+	};
+	// =================
+
+	double p = std::sqrt(AddEm(x)) * s2e;
+	double w = P[15];
+	for (size_t i = 0; i < 15; i++)
+		w = w * p + P[14 - i];
+
+	return w;
+}
+
+inline double GeneralWm1(double x)
+{
+	static constexpr double P[] = {
+		0,
+		-5.415413805902706,
+		-2.787876451002007,
+		-0.4992978139443087
+	};
+	static constexpr double Q = 5.410664283026123;
+
+	double t = std::sqrt(-2 - 2 * std::log(-x));
+	double w = P[3];
+	for (size_t i = 0; i < 3; i++)
+		w = w * t + P[2 - i];
+
+	return w / (t + Q) - 1.0;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+#include <arb.h>
+
+// Directed conversions of an arf, through double for float
+template <typename Ty>
+Ty RoundDown(const arf_t v)
+{
+	double d = arf_get_d(v, ARF_RND_FLOOR);
+	if constexpr (std::is_same_v<Ty, float>)
+	{
+		float f = (float)d;
+		return ((double)f > d) ? std::nextafter(f, -INFINITY) : f;
+	}
+	else
+		return d;
+}
+
+template <typename Ty>
+Ty RoundUp(const arf_t v)
+{
+	double d = arf_get_d(v, ARF_RND_CEIL);
+	if constexpr (std::is_same_v<Ty, float>)
+	{
+		float f = (float)d;
+		return ((double)f < d) ? std::nextafter(f, INFINITY) : f;
+	}
+	else
+		return d;
+}
+
+/*
+y = exp(a + d) from an enclosure expA of exp(a), for |d| < 2^maxExp with maxExp <= -1
+
+With |d| <= 1/2, truncating the Taylor series of exp(d) after d^n leaves a remainder below
+|d|^(n+1) / (n+1)! e^|d| <= |d|^(n+1), which is added to the radius, and n is chosen so this is below
+2^-prec. series and err are scratch.
+*/
+inline void ExpShifted(arb_t y, const arb_t expA, const arb_t d, slong maxExp, slong prec, arb_t series, mag_t err)
+{
+	// Terms up to d^n with |d|^(n+1) < 2^-prec
+	slong e = std::clamp(arf_abs_bound_lt_2exp_si(arb_midref(d)), -prec, maxExp);
+	slong n = std::max<slong>((prec - e - 1) / -e - 1, 1);
+
+	arb_one(series);
+	for (slong k = n; k >= 1; k--)
+	{
+		arb_mul(series, series, d, prec);
+		arb_div_ui(series, series, (ulong)k, prec);
+		arb_add_ui(series, series, 1, prec);
+	}
+
+	arb_get_mag(err, d);
+	mag_pow_ui(err, err, (ulong)n + 1);
+	arb_add_error_mag(series, err);
+	arb_mul(y, expA, series, prec);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+Function multiversioning for the scalar hot paths
+
+REFERENCEW_TARGET_CLONES compiles a function for baseline x86-64 (SSE2), x86-64-v3 (AVX2, FMA, BMI2)
+and x86-64-v4 (AVX-512), and the loader picks the best clone for the running CPU through an ifunc.
+This lets one portable build use the wider instruction sets where the hardware has them. It is
+only applied to functions large enough to amortize the indirect call, and compiles away where
+ifuncs aren't available, on MSVC, or when the build already targets the native CPU.
+*/
+#ifndef REFERENCEW_MULTIVERSION
+#define REFERENCEW_MULTIVERSION 0
+#endif
+
+#if REFERENCEW_MULTIVERSION && defined(__x86_64__) && defined(__ELF__) && \
+	((defined(__clang__) && __clang_major__ >= 14) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 12))
+#define REFERENCEW_TARGET_CLONES __attribute__((target_clones("default", "arch=x86-64-v3", "arch=x86-64-v4")))
+#else
+#define REFERENCEW_TARGET_CLONES
+#endif
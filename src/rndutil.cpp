@@ -109,6 +109,12 @@ std::pair<double, double> LogUpDown(double x)
 	return { std::nextafter(v, -INFINITY), std::nextafter(v, INFINITY) };
 }
 
+float narrow(double x, int rnd)
+{
+	fesetround(rnd);
+	return (float)x;
+}
+
 void ExpUpDown(mpfr_t down, mpfr_t up, mpfr_t x)
 {
 	int isBelow = mpfr_exp(down, x, MPFR_RNDD);
@@ -25,5 +25,8 @@ float fma(double x, double y, double z, int rnd);
 std::pair<double, double> ExpUpDown(double x);
 std::pair<double, double> LogUpDown(double x);
 
+// double -> float
+float narrow(double x, int rnd);
+
 // mpfr
 void ExpUpDown(mpfr_t down, mpfr_t up, mpfr_t x);
\ No newline at end of file
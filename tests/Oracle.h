@@ -0,0 +1,262 @@
+#pragma once
+#include <iostream>
+#include <cmath>
+#include <type_traits>
+#include <numeric>
+#include <format>
+
+#include <mpfr.h>
+
+/*
+Verification oracle for w e^w - x
+
+The sign of the residual is decided by the cheapest rigorous method which is conclusive:
+	- float: a double enclosure built from std::exp widened by 2ulps, which is conclusive unless
+	  w e^w is within a few double ulps of x. This relies on std::exp being within 1ulp, which glibc
+	  documents, so it is only used with glibc and once a spot check against MPFR has passed
+	- MPFR at 128 bits, then 256 bits
+
+Both endpoints of a 1ulp interval share one MPFR exp: with d = sup - inf, exp(sup) = exp(inf) e^d
+and 1 + d <= e^d <= 1 + d + d^2 for 0 <= d <= 1, with d rounded down for the lower bound and up for
+the upper one. All MPFR state is allocated once per oracle.
+
+A sign which stays inconclusive at 256 bits is reported and the interval is taken as not enclosing.
+
+Derivative enclosures are checked against W'(x) = W / (x (1 + W)) from W refined to 256 bits by
+Newton's method, started from a verified enclosure.
+*/
+template <typename Ty>
+class Oracle
+{
+public:
+	Oracle()
+	{
+		for (size_t i = 0; i < 2; i++)
+		{
+			Scratch& s = scratch[i];
+			mpfr_prec_t prec = (i == 0) ? 128 : 256;
+			mpfr_init2(s.w, 53);
+			mpfr_init2(s.d, 53);
+			mpfr_init2(s.expLow, prec);
+			mpfr_init2(s.expHigh, prec);
+			mpfr_init2(s.tLow, prec);
+			mpfr_init2(s.tHigh, prec);
+			mpfr_init2(s.low, prec);
+			mpfr_init2(s.high, prec);
+		}
+
+		for (mpfr_t* v : { &root, &expRoot, &num, &den })
+			mpfr_init2(*v, 256);
+	}
+
+	~Oracle()
+	{
+		for (Scratch& s : scratch)
+		{
+			mpfr_clear(s.w);
+			mpfr_clear(s.d);
+			mpfr_clear(s.expLow);
+			mpfr_clear(s.expHigh);
+			mpfr_clear(s.tLow);
+			mpfr_clear(s.tHigh);
+			mpfr_clear(s.low);
+			mpfr_clear(s.high);
+		}
+
+		for (mpfr_t* v : { &root, &expRoot, &num, &den })
+			mpfr_clear(*v);
+	}
+
+	Oracle(const Oracle&) = delete;
+	Oracle& operator=(const Oracle&) = delete;
+
+	// Returns true if [inf, sup] contains the root of w e^w - x
+	bool Encloses(Ty x, Ty inf, Ty sup)
+	{
+		// Only exact roots may give a point interval
+		if (inf == sup)
+			return inf == 0 && x == 0;
+
+		int infSign = Inconclusive, supSign = Inconclusive;
+		if constexpr (std::is_same_v<Ty, float>)
+		{
+			static const bool hasAccurateExp = HasAccurateExp();
+			if (hasAccurateExp)
+			{
+				infSign = FastSign(x, inf);
+				supSign = FastSign(x, sup);
+			}
+		}
+
+		for (Scratch& s : scratch)
+		{
+			if (infSign != Inconclusive && supSign != Inconclusive)
+				break;
+			MpfrSigns(s, x, inf, sup, infSign, supSign);
+		}
+
+		if (infSign == Inconclusive || supSign == Inconclusive)
+		{
+			std::cerr << std::format("Oracle sign inconclusive at 256 bits, x: {}, enclosure: [{}, {}]\n", x, inf, sup);
+			return false;
+		}
+
+		return (infSign <= 0 && supSign >= 0) || (infSign >= 0 && supSign <= 0);
+	}
+
+	// Returns true if [dInf, dSup] contains W'(x), given [inf, sup] enclosing W(x)
+	bool EnclosesDerivative(Ty x, Ty inf, Ty sup, Ty dInf, Ty dSup)
+	{
+		// === Parameters ===
+		static constexpr size_t Iterations = 6; // From 1ulp, well past 256 bits
+		// ==================
+
+		mpfr_set_d(root, std::midpoint(inf, sup), MPFR_RNDN);
+		for (size_t i = 0; i < Iterations; i++)
+		{
+			// root -= (root e^root - x) / (e^root (1 + root))
+			mpfr_exp(expRoot, root, MPFR_RNDN);
+			mpfr_mul(num, expRoot, root, MPFR_RNDN);
+			mpfr_sub_d(num, num, x, MPFR_RNDN);
+			mpfr_add_ui(den, root, 1, MPFR_RNDN);
+			mpfr_mul(den, den, expRoot, MPFR_RNDN);
+			mpfr_div(num, num, den, MPFR_RNDN);
+			mpfr_sub(root, root, num, MPFR_RNDN);
+		}
+
+		// W' = W / (x (1 + W))
+		mpfr_add_ui(den, root, 1, MPFR_RNDN);
+		mpfr_mul_d(den, den, x, MPFR_RNDN);
+		mpfr_div(num, root, den, MPFR_RNDN);
+
+		return mpfr_cmp_d(num, dInf) >= 0 && mpfr_cmp_d(num, dSup) <= 0;
+	}
+
+private:
+	static constexpr int Inconclusive = 2;
+
+	struct Scratch
+	{
+		mpfr_t w, d, expLow, expHigh, tLow, tHigh, low, high;
+	};
+	Scratch scratch[2];
+	mpfr_t root, expRoot, num, den;
+
+	// Spot checks that std::exp is within 1ulp over the range of float arguments, so FastSign's 2ulp
+	// widening holds. glibc documents the bound, other libraries always use MPFR.
+	static bool HasAccurateExp()
+	{
+#ifdef __GLIBC__
+		// === Parameters ===
+		static constexpr size_t NumPoints = 1 << 16;
+		// ==================
+
+		mpfr_t w, exact;
+		mpfr_init2(w, 53);
+		mpfr_init2(exact, 128);
+
+		bool isAccurate = true;
+		for (size_t i = 0; i < NumPoints && isAccurate; i++)
+		{
+			float wf = -103.0f + 192.0f * (float)i / NumPoints;
+			double e = std::exp((double)wf);
+			if (e == 0 || !std::isfinite(e))
+				continue;
+
+			// |exact - e| <= ulp(e)
+			mpfr_set_d(w, wf, MPFR_RNDN);
+			mpfr_exp(exact, w, MPFR_RNDN);
+			mpfr_sub_d(exact, exact, e, MPFR_RNDN);
+			mpfr_abs(exact, exact, MPFR_RNDN);
+			isAccurate = mpfr_cmp_d(exact, std::nextafter(e, INFINITY) - e) <= 0;
+		}
+
+		mpfr_clear(w);
+		mpfr_clear(exact);
+		if (!isAccurate)
+			std::cerr << "std::exp is less accurate than 1ulp, the oracle will use MPFR for every sign\n";
+		return isAccurate;
+#else
+		return false;
+#endif
+	}
+
+	static int FastSign(float x, float w)
+	{
+		double e = std::exp((double)w);
+		double expLow = std::nextafter(std::nextafter(e, -INFINITY), -INFINITY);
+		double expHigh = std::nextafter(std::nextafter(e, INFINITY), INFINITY);
+
+		// w e^w, each rounding widened by an ulp
+		double wd = w;
+		double pLow = std::nextafter(wd * ((w < 0) ? expHigh : expLow), -INFINITY);
+		double pHigh = std::nextafter(wd * ((w < 0) ? expLow : expHigh), INFINITY);
+
+		double rLow = std::nextafter(pLow - (double)x, -INFINITY);
+		double rHigh = std::nextafter(pHigh - (double)x, INFINITY);
+
+		if (rLow > 0)
+			return 1;
+		if (rHigh < 0)
+			return -1;
+		return Inconclusive;
+	}
+
+	// Residual sign at w, given [expLow, expHigh] containing e^w
+	static int MpfrSign(Scratch& s, Ty x, Ty w)
+	{
+		mpfr_set_d(s.w, w, MPFR_RNDN);
+		bool isNeg = mpfr_cmp_ui(s.w, 0) < 0;
+
+		mpfr_mul(s.low, isNeg ? s.expHigh : s.expLow, s.w, MPFR_RNDD);
+		mpfr_sub_d(s.low, s.low, x, MPFR_RNDD);
+		mpfr_mul(s.high, isNeg ? s.expLow : s.expHigh, s.w, MPFR_RNDU);
+		mpfr_sub_d(s.high, s.high, x, MPFR_RNDU);
+
+		int lowCmp = mpfr_cmp_ui(s.low, 0);
+		int highCmp = mpfr_cmp_ui(s.high, 0);
+
+		if (lowCmp == 0 && highCmp == 0)
+			return 0;
+		if (lowCmp >= 0)
+			return 1;
+		if (highCmp <= 0)
+			return -1;
+		return Inconclusive;
+	}
+
+	static void Exp(Scratch& s, Ty w)
+	{
+		mpfr_set_d(s.w, w, MPFR_RNDN);
+		int isBelow = mpfr_exp(s.expLow, s.w, MPFR_RNDD);
+		mpfr_set(s.expHigh, s.expLow, MPFR_RNDN);
+		if (isBelow) mpfr_nextabove(s.expHigh);
+	}
+
+	static void MpfrSigns(Scratch& s, Ty x, Ty inf, Ty sup, int& infSign, int& supSign)
+	{
+		Exp(s, inf);
+		if (infSign == Inconclusive)
+			infSign = MpfrSign(s, x, inf);
+		if (supSign != Inconclusive)
+			return;
+
+		// exp(sup) from exp(inf) when the endpoints are close, d rounded down into tLow and up into d
+		mpfr_set_d(s.d, sup, MPFR_RNDN);
+		mpfr_sub_d(s.tLow, s.d, inf, MPFR_RNDD);
+		mpfr_sub_d(s.d, s.d, inf, MPFR_RNDU);
+		if (mpfr_number_p(s.d) && mpfr_sgn(s.d) >= 0 && mpfr_cmp_d(s.d, 0x1p-20) <= 0)
+		{
+			mpfr_add_ui(s.tLow, s.tLow, 1, MPFR_RNDD);
+			mpfr_sqr(s.tHigh, s.d, MPFR_RNDU);
+			mpfr_add(s.tHigh, s.tHigh, s.d, MPFR_RNDU);
+			mpfr_add_ui(s.tHigh, s.tHigh, 1, MPFR_RNDU);
+			mpfr_mul(s.expLow, s.expLow, s.tLow, MPFR_RNDD);
+			mpfr_mul(s.expHigh, s.expHigh, s.tHigh, MPFR_RNDU);
+		}
+		else
+			Exp(s, sup);
+
+		supSign = MpfrSign(s, x, sup);
+	}
+};
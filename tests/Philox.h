@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+// Philox4x32-10 counter based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+// Every (key, stream) pair is an independent sequence, so point i of a test can be generated
+// directly from (seed, i) without running any other point's generator
+class Philox
+{
+public:
+	using result_type = uint64_t;
+
+	Philox(uint64_t key_, uint64_t stream_)
+		: key{ (uint32_t)key_, (uint32_t)(key_ >> 32) }, stream(stream_) {}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()()
+	{
+		if (bufferIdx == 2)
+		{
+			Block();
+			bufferIdx = 0;
+		}
+		return buffer[bufferIdx++];
+	}
+
+protected:
+	uint32_t key[2];
+	uint64_t stream, counter = 0;
+	uint64_t buffer[2];
+	size_t bufferIdx = 2;
+
+	void Block()
+	{
+		static constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+		static constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+		uint32_t c[4] = { (uint32_t)counter, (uint32_t)(counter >> 32), (uint32_t)stream, (uint32_t)(stream >> 32) };
+		uint32_t k[2] = { key[0], key[1] };
+
+		for (size_t round = 0; round < 10; round++)
+		{
+			uint64_t p0 = (uint64_t)M0 * c[0];
+			uint64_t p1 = (uint64_t)M1 * c[2];
+			uint32_t next[4] = {
+				(uint32_t)(p1 >> 32) ^ c[1] ^ k[0],
+				(uint32_t)p1,
+				(uint32_t)(p0 >> 32) ^ c[3] ^ k[1],
+				(uint32_t)p0
+			};
+			c[0] = next[0]; c[1] = next[1]; c[2] = next[2]; c[3] = next[3];
+			k[0] += W0;
+			k[1] += W1;
+		}
+
+		buffer[0] = ((uint64_t)c[1] << 32) | c[0];
+		buffer[1] = ((uint64_t)c[3] << 32) | c[2];
+		counter++;
+	}
+};
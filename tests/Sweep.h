@@ -0,0 +1,364 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <format>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <csignal>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+struct SweepOptions
+{
+	size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+	size_t shardsPerThread = 64;
+	double progressInterval = 10.0; // Seconds between progress reports
+	bool keepGoing = false; // Continue past failures
+	uint64_t stopAfter = UINT64_MAX; // Stop once this many points are complete, as if interrupted
+
+	// Checkpointing, disabled if path is empty
+	std::string checkpointPath;
+	std::string sweepId; // Identifies the sweep, a checkpoint is only resumed by the same sweep
+	double checkpointInterval = 60.0;
+	bool resume = false;
+};
+
+struct Shard
+{
+	uint64_t begin, end;
+	std::atomic<uint64_t> next; // Every point in [begin, next) is complete
+};
+
+/*
+Checkpoint file, written to a temporary and renamed over the previous one so a preempted job never
+leaves a truncated file behind
+	ReferenceLambertW sweep 1
+	id <sweepId>
+	points <numPoints>
+	shards <numShards>
+	<begin> <end> <next>	(one line per shard)
+	failures <numFailures>
+	<index>					(one line per failure)
+*/
+inline bool WriteCheckpoint(const SweepOptions& options, uint64_t numPoints, const std::vector<Shard>& shards, const std::vector<uint64_t>& failures)
+{
+	std::string tempPath = options.checkpointPath + ".tmp";
+	{
+		std::ofstream file{ tempPath };
+		file << "ReferenceLambertW sweep 1\n";
+		file << std::format("id {}\npoints {}\nshards {}\n", options.sweepId, numPoints, shards.size());
+		for (const Shard& shard : shards)
+			file << std::format("{} {} {}\n", shard.begin, shard.end, (uint64_t)shard.next);
+		file << std::format("failures {}\n", failures.size());
+		for (uint64_t failure : failures)
+			file << failure << '\n';
+
+		if (!file.flush())
+			return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, options.checkpointPath, ec);
+	return !ec;
+}
+
+inline bool ReadCheckpoint(const SweepOptions& options, uint64_t numPoints, std::vector<Shard>& shards, std::vector<uint64_t>& failures)
+{
+	std::ifstream file{ options.checkpointPath };
+	std::string header, idKey, id, key;
+	uint64_t filePoints, numShards, numFailures;
+
+	std::getline(file, header);
+	file >> idKey >> id;
+	if (header != "ReferenceLambertW sweep 1" || id != options.sweepId)
+		return false;
+
+	file >> key >> filePoints;
+	if (key != "points" || filePoints != numPoints)
+		return false;
+
+	// Shards are non-empty, so there can't be more than points
+	file >> key >> numShards;
+	if (key != "shards" || !file || numShards > numPoints)
+		return false;
+
+	// Shards must tile [0, numPoints) in order, with their progress inside them
+	shards = std::vector<Shard>(numShards);
+	uint64_t expectedBegin = 0;
+	for (Shard& shard : shards)
+	{
+		uint64_t next;
+		file >> shard.begin >> shard.end >> next;
+		if (!file || shard.begin != expectedBegin || shard.end <= shard.begin || next < shard.begin || next > shard.end)
+			return false;
+		shard.next = next;
+		expectedBegin = shard.end;
+	}
+	if (expectedBegin != numPoints)
+		return false;
+
+	file >> key >> numFailures;
+	if (key != "failures" || !file || numFailures > numPoints)
+		return false;
+	failures.resize(numFailures);
+	for (uint64_t& failure : failures)
+	{
+		file >> failure;
+		if (failure >= numPoints)
+			return false;
+	}
+
+	return (bool)file;
+}
+
+// Set by SIGINT/SIGTERM, workers stop at the next chunk so the final checkpoint is consistent
+inline volatile std::sig_atomic_t sweepInterrupted = 0;
+
+// CPUs this process may run on, interleaved across NUMA nodes so that any prefix of the list
+// spreads evenly over the nodes
+inline std::vector<int> GetCpuOrder()
+{
+	std::vector<int> order;
+#ifdef __linux__
+	cpu_set_t allowed;
+	if (sched_getaffinity(0, sizeof(allowed), &allowed))
+		return order;
+
+	// Group allowed CPUs by node
+	std::vector<std::vector<int>> nodes;
+	for (int node = 0;; node++)
+	{
+		std::ifstream file{ std::format("/sys/devices/system/node/node{}/cpulist", node) };
+		if (!file)
+			break;
+
+		// cpulist is a comma separated list of ranges, e.g. 0-7,16-23
+		std::vector<int> cpus;
+		std::string range;
+		while (std::getline(file, range, ','))
+		{
+			int first = 0, last = 0;
+			if (sscanf(range.c_str(), "%d-%d", &first, &last) < 2)
+				last = first;
+			for (int cpu = first; cpu <= last; cpu++)
+				if (CPU_ISSET(cpu, &allowed))
+					cpus.push_back(cpu);
+		}
+		if (!cpus.empty())
+			nodes.push_back(std::move(cpus));
+	}
+
+	// No NUMA information, use allowed CPUs in order
+	if (nodes.empty())
+	{
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			if (CPU_ISSET(cpu, &allowed))
+				order.push_back(cpu);
+		return order;
+	}
+
+	for (size_t i = 0;; i++)
+	{
+		bool any = false;
+		for (const auto& cpus : nodes)
+		{
+			if (i < cpus.size())
+			{
+				order.push_back(cpus[i]);
+				any = true;
+			}
+		}
+		if (!any) break;
+	}
+#endif
+	return order;
+}
+
+// Pins the calling thread, must run before the worker allocates so its memory is node local
+inline void PinThread(const std::vector<int>& cpuOrder, size_t workerIdx)
+{
+#ifdef __linux__
+	if (cpuOrder.empty())
+		return;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpuOrder[workerIdx % cpuOrder.size()], &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	(void)cpuOrder;
+	(void)workerIdx;
+#endif
+}
+
+// Runs worker(i) for every i in [0, numPoints) across several threads. The range is split into
+// shards which threads claim in order, so expensive regions of the range don't serialize on a
+// single thread. makeWorker is called once per thread, and should return a callable owning its own
+// evaluator which returns non-zero on failure. Returns non-zero if any point failed, or if the
+// sweep was interrupted before completing.
+template <typename MakeWorker>
+int RunSweep(uint64_t numPoints, const SweepOptions& options, MakeWorker makeWorker)
+{
+	using Clock = std::chrono::steady_clock;
+
+	// === Parameters ===
+	static constexpr uint64_t Chunk = 4096; // Points between progress updates
+	// ==================
+
+	// Shard layout
+	std::vector<Shard> shards;
+	std::vector<uint64_t> failures;
+	bool useCheckpoint = !options.checkpointPath.empty();
+	if (useCheckpoint && options.resume && std::filesystem::exists(options.checkpointPath))
+	{
+		if (!ReadCheckpoint(options, numPoints, shards, failures))
+		{
+			std::cerr << std::format("Checkpoint {} does not match this sweep\n", options.checkpointPath);
+			return 1;
+		}
+		std::cout << std::format("Resuming from {}, {} failures so far\n", options.checkpointPath, failures.size());
+		for (uint64_t failure : failures)
+			std::cerr << std::format("Previous failure at index: {}\n", failure);
+	}
+	else
+	{
+		size_t numShards = std::max<size_t>(options.threads * options.shardsPerThread, 1);
+		uint64_t shardSize = std::max<uint64_t>((numPoints + numShards - 1) / numShards, 1);
+		shards = std::vector<Shard>((numPoints + shardSize - 1) / shardSize);
+		for (size_t s = 0; s < shards.size(); s++)
+		{
+			shards[s].begin = s * shardSize;
+			shards[s].end = std::min((s + 1) * shardSize, numPoints);
+			shards[s].next = shards[s].begin;
+		}
+	}
+
+	uint64_t initialDone = 0;
+	for (const Shard& shard : shards)
+		initialDone += shard.next - shard.begin;
+
+	std::atomic<uint64_t> nextShard = 0, done = initialDone;
+	std::atomic<bool> failed = !failures.empty() && !options.keepGoing, finished = false;
+	std::mutex failureMutex;
+
+	auto stopped = [&]() { return sweepInterrupted || done >= options.stopAfter || (failed && !options.keepGoing); };
+
+	std::vector<int> cpuOrder = GetCpuOrder();
+	auto work = [&](size_t workerIdx)
+	{
+		PinThread(cpuOrder, workerIdx);
+		auto worker = makeWorker();
+
+		for (;;)
+		{
+			size_t s = nextShard++;
+			if (s >= shards.size() || stopped())
+				return;
+			Shard& shard = shards[s];
+
+			for (uint64_t chunk = shard.next; chunk < shard.end; chunk += Chunk)
+			{
+				uint64_t chunkEnd = std::min(chunk + Chunk, shard.end);
+				std::vector<uint64_t> chunkFailures;
+				for (uint64_t i = chunk; i < chunkEnd; i++)
+				{
+					if (worker(i))
+					{
+						chunkFailures.push_back(i);
+						failed = true;
+					}
+				}
+
+				// Only whole chunks are recorded, an interrupted chunk is redone on resume. Its
+				// failures are recorded together with its progress, so a checkpoint never holds
+				// failures of a chunk it would redo.
+				{
+					std::scoped_lock lock{ failureMutex };
+					failures.insert(failures.end(), chunkFailures.begin(), chunkFailures.end());
+					shard.next = chunkEnd;
+				}
+				done += chunkEnd - chunk;
+				if (stopped())
+					return;
+			}
+		}
+	};
+
+	auto checkpoint = [&]()
+	{
+		std::scoped_lock lock{ failureMutex };
+		if (!WriteCheckpoint(options, numPoints, shards, failures))
+			std::cerr << std::format("Failed to write checkpoint {}\n", options.checkpointPath);
+	};
+
+	// Stop cleanly on preemption
+	auto previousInt = std::signal(SIGINT, [](int) { sweepInterrupted = 1; });
+	auto previousTerm = std::signal(SIGTERM, [](int) { sweepInterrupted = 1; });
+
+	Clock::time_point start = Clock::now();
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < options.threads; t++)
+		threads.emplace_back(work, t);
+
+	// Progress reporting and checkpointing
+	std::thread reporter{ [&]()
+	{
+		Clock::time_point lastReport = Clock::now(), lastCheckpoint = Clock::now();
+		while (!finished)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+			if (useCheckpoint && std::chrono::duration<double>(Clock::now() - lastCheckpoint).count() >= options.checkpointInterval)
+			{
+				lastCheckpoint = Clock::now();
+				checkpoint();
+			}
+
+			if (std::chrono::duration<double>(Clock::now() - lastReport).count() < options.progressInterval)
+				continue;
+			lastReport = Clock::now();
+
+			double elapsed = std::chrono::duration<double>(lastReport - start).count();
+			double fraction = (double)done / (double)numPoints;
+			double rate = (double)(done - initialDone) / elapsed;
+			double eta = (rate > 0) ? (double)(numPoints - done) / rate : 0;
+			std::cout << std::format("{:.2f}% ({} / {}) {:.0f}s elapsed, ~{:.0f}s left\n", fraction * 100, (uint64_t)done, numPoints, elapsed, eta);
+		}
+	} };
+
+	for (std::thread& thread : threads)
+		thread.join();
+	finished = true;
+	reporter.join();
+
+	std::signal(SIGINT, previousInt);
+	std::signal(SIGTERM, previousTerm);
+
+	if (useCheckpoint)
+		checkpoint();
+
+	if (sweepInterrupted)
+	{
+		std::cerr << "Sweep interrupted\n";
+		return 1;
+	}
+	if (done < numPoints && done >= options.stopAfter)
+	{
+		std::cerr << std::format("Sweep stopped after {} points\n", (uint64_t)done);
+		return 1;
+	}
+
+	return failures.empty() ? 0 : 1;
+}
\ No newline at end of file
@@ -3,15 +3,32 @@
 #include <charconv>
 #include <random>
 #include <format>
-#include <functional>
+#include <cfloat>
+#include <vector>
+#include <algorithm>
+#include <chrono>
 
 #include <mpfr.h>
 #include <ReferenceLambertW.h>
 
 #include "ReciprocalDistributionEx.h"
+#include "../src/Ordered.h"
+#include "../src/Arena.h"
+#include "Sweep.h"
+#include "Oracle.h"
+#include "Philox.h"
+#include "../engines/Engine.h"
 
 #define ERROR(msg) { std::cerr << msg << '\n'; return 1; }
 
+// Evaluator backend under test, from --engine
+std::string engineName = "reference";
+
+// ReferenceW feature under test by FeatureTest, from --feature
+enum class Feature { Widths, Budget, Certificate, Derivative };
+inline constexpr const char* FeatureNames[] = { "widths", "budget", "certificate", "derivative" };
+Feature feature = Feature::Widths;
+
 template <typename Ty>
 consteval Ty GetEmUp()
 {
@@ -22,184 +39,541 @@ consteval Ty GetEmUp()
 }
 
 template <typename Ty>
-mpfr_prec_t GetPrec()
+int TestPoint(Ty x, const BasicInterval<Ty>& res)
 {
-	if constexpr (std::is_same_v<Ty, float>)
-		return 24;
-	else
-		return 53;
+	if (res.inf != res.sup && res.sup != std::nextafter(res.inf, INFINITY))
+	{
+		std::cerr << std::format("Too wide x: {}\n", x);
+		return 1;
+	}
+
+	thread_local Oracle<Ty> oracle;
+	if (!oracle.Encloses(x, res.inf, res.sup))
+	{
+		std::cerr << std::format("Incorrect x: {}\n", x);
+		return 1;
+	}
+
+	return 0;
 }
 
+struct RandomOptions
+{
+	uint64_t seed = 0;
+	uint64_t points = 500'000; // Per distribution
+	uint64_t shard = 0, numShards = 1;
+	int64_t index = -1; // Replays a single point if non-negative
+};
+
+// Randomized test inputs as a pure function of (seed, index), so any shard of the index space can be
+// run independently and any failing point can be replayed on its own
 template <typename Ty>
-bool WexpwIsPositive(Ty w, Ty x)
+class PointSampler
 {
-	mpfr_t wMpfr, yLow, yHigh;
-	mpfr_init2(wMpfr, GetPrec<Ty>());
-	mpfr_init2(yLow, 150);
-	mpfr_init2(yHigh, 150);
+public:
+	PointSampler(int64_t branch, uint64_t seed_, uint64_t points_)
+		: seed(seed_), points(points_),
+		reciprocalDist{ GetEmUp<Ty>(), (branch == 0) ? (Ty)INFINITY : (Ty)0, false },
+		nearBranchDist{ std::is_same_v<Ty, float> ? (Ty)-18.021828 : (Ty)-38.123094930796995, (Ty)-1 } {}
 
-	// Convert w to mpfr
-	if constexpr (std::is_same_v<Ty, float>)
-		mpfr_set_flt(wMpfr, w, MPFR_RNDN);
-	else
-		mpfr_set_d(wMpfr, w, MPFR_RNDN);
+	uint64_t Size() const
+	{
+		return 2 * points;
+	}
 
-	// Compute exp
-	mpfr_exp(yLow, wMpfr, MPFR_RNDD);
-	mpfr_set(yHigh, yLow, MPFR_RNDN);
-	mpfr_nextabove(yHigh);
-	if (mpfr_cmp_ui(wMpfr, 0) < 0)
-		mpfr_swap(yLow, yHigh);
+	Ty operator()(uint64_t i)
+	{
+		Philox gen{ seed, i };
 
-	// Compute yLow
-	mpfr_mul(yLow, yLow, wMpfr, MPFR_RNDD);
-	mpfr_sub_d(yLow, yLow, x, MPFR_RNDD);
+		// ReciprocalDist test
+		if (i < points)
+			return reciprocalDist(gen);
 
-	// Compute yHigh
-	mpfr_mul(yHigh, yHigh, wMpfr, MPFR_RNDU);
-	mpfr_sub_d(yHigh, yHigh, x, MPFR_RNDU);
+		// Near branch test
+		return GetEmUp<Ty>() + exp(nearBranchDist(gen));
+	}
 
-	int lowCmp = mpfr_cmp_ui(yLow, 0);
-	int highCmp = mpfr_cmp_ui(yHigh, 0);
+protected:
+	uint64_t seed, points;
+	ReciprocalDistributionEx<Ty> reciprocalDist;
+	std::uniform_real_distribution<Ty> nearBranchDist;
+};
 
-	mpfr_clear(wMpfr);
-	mpfr_clear(yLow);
-	mpfr_clear(yHigh);
+// Runs this shard's part of the randomized index space, makeTest is called once per thread and
+// returns a callable which tests a single x
+template <typename Ty, typename MakeTest>
+int RunRandomized(int64_t branch, const SweepOptions& options, const RandomOptions& random, MakeTest makeTest)
+{
+	PointSampler<Ty> sampler{ branch, random.seed, random.points };
 
-	if (lowCmp >= 0 && highCmp >= 0)
-		return true;
-	if (lowCmp <= 0 && highCmp <= 0)
-		return false;
+	uint64_t first = sampler.Size() * random.shard / random.numShards;
+	uint64_t count = sampler.Size() * (random.shard + 1) / random.numShards - first;
+	if (random.index >= 0)
+	{
+		first = (uint64_t)random.index;
+		count = 1;
+	}
 
-	std::cerr << "Inconclusive sign!\n";
-	throw;
+	return RunSweep(count, options, [&]()
+	{
+		return [first, seed = random.seed, sampler = sampler, test = makeTest()](uint64_t i) mutable
+		{
+			Ty x = sampler(first + i);
+			if (test(x))
+			{
+				std::cerr << std::format("Seed: {} Index: {} x: {:a}\n", seed, first + i, x);
+				return 1;
+			}
+			return 0;
+		};
+	});
 }
 
 template <typename Ty>
-int TestPoint(Ty x, const std::conditional_t<std::is_same_v<Ty, float>, Intervalf, Interval>& res)
+int RunTest(int64_t branch, const SweepOptions& options, const RandomOptions& random)
 {
-	if (res.inf != res.sup && res.sup != std::nextafter(res.inf, INFINITY))
+	int ret = RunRandomized<Ty>(branch, options, random, [branch]()
 	{
-		std::cerr << std::format("Too wide x: {}\n", x);
+		return [branch, evaluator = MakeEngine<Ty>(engineName)](Ty x) mutable
+		{
+			typename Engine<Ty>::IntervalTy res;
+			if (branch == 0)
+				res = evaluator->W0(x);
+			else
+				res = evaluator->Wm1(x);
+
+			return TestPoint(x, res);
+		};
+	});
+	if (ret)
 		return 1;
+
+	// Zero test
+	if (branch == 0 && random.shard == 0 && random.index < 0)
+	{
+		auto [inf, sup] = MakeEngine<Ty>(engineName)->W0(0);
+		if (inf != 0 || sup != 0)
+		{
+			std::cerr << "Failed zero test!\n";
+			return 1;
+		}
 	}
 
-	if (WexpwIsPositive(res.inf, x) == WexpwIsPositive(res.sup, x))
+	return 0;
+}
+
+int RunDerivedTest(int64_t branch, const SweepOptions& options, const RandomOptions& random)
+{
+	int ret = RunRandomized<float>(branch, options, random, [branch]()
 	{
-		std::cerr << std::format("Incorrect x: {}\n", x);
+		return [branch, evaluator = ReferenceW{}, evaluatorf = ReferenceWf{}](float x) mutable
+		{
+			Intervalf res, expected;
+			if (branch == 0)
+			{
+				res = evaluatorf.W0(x, evaluator.W0(x));
+				expected = evaluatorf.W0(x);
+			}
+			else
+			{
+				res = evaluatorf.Wm1(x, evaluator.Wm1(x));
+				expected = evaluatorf.Wm1(x);
+			}
+
+			if (TestPoint(x, res)) return 1;
+			if (res.inf != expected.inf || res.sup != expected.sup)
+			{
+				std::cerr << std::format("Derived result differs x: {}\n", x);
+				return 1;
+			}
+
+			return 0;
+		};
+	});
+	if (ret)
 		return 1;
+
+	// Edge cases
+	ReferenceW evaluator;
+	ReferenceWf evaluatorf;
+	if (branch == 0)
+	{
+		auto [inf, sup] = evaluatorf.W0(0, evaluator.W0(0));
+		if (inf != 0 || sup != 0)
+		{
+			std::cerr << "Failed zero test!\n";
+			return 1;
+		}
+
+		auto [infInf, infSup] = evaluatorf.W0(INFINITY, evaluator.W0(INFINITY));
+		if (infInf != FLT_MAX || infSup != INFINITY)
+		{
+			std::cerr << "Failed infinity test!\n";
+			return 1;
+		}
+	}
+
+	// Out of domain inputs are NaN whatever the enclosure
+	for (float x : { -0.5f, (branch == 0) ? -INFINITY : 0.5f })
+	{
+		Intervalf res = (branch == 0) ? evaluatorf.W0(x, Interval{ -0.5, 0.5 }) : evaluatorf.Wm1(x, Interval{ -2, -1.5 });
+		if (!std::isnan(res.inf) || !std::isnan(res.sup))
+			ERROR(std::format("Failed domain test x: {}", x));
+	}
+
+	// Enclosures of the other branch are ignored, and wider ones are narrowed by sign tests
+	for (float x : { -0.3f, -0.01f })
+	{
+		Intervalf expected = (branch == 0) ? evaluatorf.W0(x) : evaluatorf.Wm1(x);
+		Intervalf other = (branch == 0) ? evaluatorf.W0(x, evaluator.Wm1(x)) : evaluatorf.Wm1(x, evaluator.W0(x));
+		Intervalf wide = (branch == 0) ? evaluatorf.W0(x, evaluator.W0(x, (size_t)1 << 32)) : evaluatorf.Wm1(x, evaluator.Wm1(x, (size_t)1 << 32));
+		if (other.inf != expected.inf || other.sup != expected.sup || wide.inf != expected.inf || wide.sup != expected.sup)
+			ERROR(std::format("Failed enclosure test x: {}", x));
 	}
 
 	return 0;
 }
 
 template <typename Ty>
-int RunTest(int64_t branch, const std::function<Ty()>& rand)
+int ExhaustiveTest(int64_t branch, const SweepOptions& options)
 {
-	// === Parameters ===
-	static constexpr size_t Num = 500'000;
-	// ==================
+	OrderedInt<Ty> start = ToOrdered(GetEmUp<Ty>());
+	OrderedInt<Ty> end = ToOrdered<Ty>((branch == 0) ? INFINITY : 0);
 
-	// Construct evaluators
-	std::conditional_t<std::is_same_v<Ty, float>, ReferenceWf, ReferenceW> evaluator;
-
-	for (size_t i = 0; i < Num; i++)
+	return RunSweep((uint64_t)(end - start), options, [&]()
 	{
-		Ty x = rand();
-		
-		if constexpr (std::is_same_v<Ty, float>)
+		return [branch, start, evaluator = MakeEngine<Ty>(engineName)](uint64_t i) mutable
 		{
-			Intervalf res;
+			Ty x = FromOrdered<Ty>(start + (OrderedInt<Ty>)i);
+
+			typename Engine<Ty>::IntervalTy res;
 			if (branch == 0)
-				res = evaluator.W0(x);
+				res = evaluator->W0(x);
 			else
-				res = evaluator.Wm1(x);
+				res = evaluator->Wm1(x);
 
-			if (TestPoint(x, res)) return 1;
+			return TestPoint(x, res);
+		};
+	});
+}
+
+// Checks one feature at x, returns non-zero on failure
+template <typename Ty>
+int TestFeature(BasicReferenceW<Ty>& evaluator, int64_t branch, Ty x)
+{
+	using Evaluator = BasicReferenceW<Ty>;
+	thread_local Oracle<Ty> oracle;
+
+	switch (feature)
+	{
+	case Feature::Widths:
+	{
+		// Within maxUlps and still enclosing the root, and the bracket alone enclosing it
+		for (size_t maxUlps : { (size_t)2, (size_t)4, (size_t)64, Evaluator::BracketOnly })
+		{
+			auto [inf, sup] = (branch == 0) ? evaluator.W0(x, maxUlps) : evaluator.Wm1(x, maxUlps);
+			if (maxUlps != Evaluator::BracketOnly && UlpDistance(inf, sup) > maxUlps)
+				ERROR(std::format("Wider than {}ulps x: {}", maxUlps, x));
+			if (!oracle.Encloses(x, inf, sup))
+				ERROR(std::format("Incorrect at {}ulps x: {}", maxUlps, x));
 		}
-		else
+		return 0;
+	}
+	case Feature::Budget:
+	{
+		// Partial enclosures contain the root, and refine to the unlimited result
+		static constexpr typename Evaluator::Budget Budgets[] = { { 0 }, { 8 }, { SIZE_MAX, false } };
+		auto expected = (branch == 0) ? evaluator.W0(x) : evaluator.Wm1(x);
+		for (const auto& budget : Budgets)
 		{
-			Interval res;
-			if (branch == 0)
-				res = evaluator.W0(x);
-			else
-				res = evaluator.Wm1(x);
+			auto partial = (branch == 0) ? evaluator.W0(x, budget) : evaluator.Wm1(x, budget);
+			if (!oracle.Encloses(x, partial.enclosure.inf, partial.enclosure.sup))
+				ERROR(std::format("Incorrect partial enclosure x: {}", x));
 
-			if (TestPoint(x, res)) return 1;
+			auto [inf, sup] = evaluator.Refine(x, partial).enclosure;
+			if (inf != expected.inf || sup != expected.sup)
+				ERROR(std::format("Refined result differs x: {}", x));
 		}
+		return 0;
+	}
+	case Feature::Certificate:
+	{
+		// Certificates verify, and stop verifying one ulp up, off the root
+		typename Evaluator::Certificate certificate;
+		auto res = (branch == 0) ? evaluator.W0(x, certificate) : evaluator.Wm1(x, certificate);
+		if (TestPoint(x, res)) return 1;
+		if (!evaluator.Verify(certificate))
+			ERROR(std::format("Certificate rejected x: {}", x));
+
+		auto shifted = certificate;
+		shifted.low = certificate.high;
+		shifted.high = std::nextafter(certificate.high, (Ty)INFINITY);
+		if (evaluator.Verify(shifted))
+			ERROR(std::format("Shifted certificate accepted x: {}", x));
+		return 0;
+	}
+	case Feature::Derivative:
+	{
+		// Contains W'(x) from the oracle's own W, with the branch's sign
+		auto [w, derivative] = (branch == 0) ? evaluator.W0WithDerivative(x) : evaluator.Wm1WithDerivative(x);
+		if (TestPoint(x, w)) return 1;
+
+		bool isContained = oracle.EnclosesDerivative(x, w.inf, w.sup, derivative.inf, derivative.sup);
+		bool isSigned = (branch == 0) ? derivative.inf >= 0 : derivative.sup <= 0;
+		if (!isContained || !isSigned)
+			ERROR(std::format("Incorrect derivative [{}, {}] x: {}", derivative.inf, derivative.sup, x));
+		return 0;
+	}
 	}
 
-	return 0;
+	return 1;
 }
 
+// Edge cases of one feature, away from the randomized points
 template <typename Ty>
-int RunTest(int64_t branch)
+int TestFeatureEdgeCases(int64_t branch)
 {
-	static std::mt19937_64 gen{ std::random_device{}() };
+	using Evaluator = BasicReferenceW<Ty>;
+	Evaluator evaluator{ GetSearchMethod(engineName) };
+	auto eval = [&](Ty x, auto... args) { return (branch == 0) ? evaluator.W0(x, args...) : evaluator.Wm1(x, args...); };
+	const std::vector<Ty> points = (branch == 0) ? std::vector<Ty>{ (Ty)-0.3, (Ty)-1e-3, 1, (Ty)1e10 } : std::vector<Ty>{ (Ty)-0.3, (Ty)-1e-3, (Ty)-1e-20 };
 
-	// ReciprocalDist test
+	switch (feature)
 	{
-		Ty low = GetEmUp<Ty>();
-		Ty high = (branch == 0) ? INFINITY : 0;
+	case Feature::Widths:
+		// BracketOnly is the certified bracket around the 1ulp enclosure, and maxUlps 0 means 1
+		for (Ty x : points)
+		{
+			auto tight = eval(x);
+			auto bracket = eval(x, Evaluator::BracketOnly);
+			auto zero = eval(x, (size_t)0);
+			if (bracket.inf > tight.inf || bracket.sup < tight.sup || zero.inf != tight.inf || zero.sup != tight.sup)
+				ERROR(std::format("Failed width edge case x: {}", x));
+		}
+		if (branch == 0 && (eval(0, Evaluator::BracketOnly).inf != 0 || !std::isnan(eval((Ty)-1, Evaluator::BracketOnly).inf)))
+			ERROR("Failed BracketOnly edge cases");
+		return 0;
 
-		ReciprocalDistributionEx<Ty> dist{ low, high, false };
-		if (RunTest<Ty>(branch, [&]() { return dist(gen); }))
-			return 1;
+	case Feature::Budget:
+	{
+		// An exhausted budget, by count or deadline, returns the bracket untouched in every search
+		// method, and refining with it changes nothing
+		using Clock = std::chrono::steady_clock;
+		const typename Evaluator::Budget exhausted[] = { { 0 }, { SIZE_MAX, true, Clock::now() - std::chrono::seconds(1) } };
+		for (SearchMethod method : { SearchMethod::Bisection, SearchMethod::Illinois, SearchMethod::Newton })
+		{
+			Evaluator budgeted{ method };
+			for (Ty x : points)
+			{
+				auto bracket = eval(x, Evaluator::BracketOnly);
+				for (const auto& budget : exhausted)
+				{
+					auto partial = (branch == 0) ? budgeted.W0(x, budget) : budgeted.Wm1(x, budget);
+					auto refined = budgeted.Refine(x, partial, budget);
+					bool isBracket = partial.enclosure.inf == bracket.inf && partial.enclosure.sup == bracket.sup;
+					bool isUnchanged = refined.enclosure.inf == bracket.inf && refined.enclosure.sup == bracket.sup;
+					if (!isBracket || !isUnchanged || partial.isTight != (UlpDistance(bracket.inf, bracket.sup) <= 1))
+						ERROR(std::format("Failed exhausted budget x: {}", x));
+				}
+			}
+		}
+		return 0;
 	}
 
-	// Near branch test
+	case Feature::Certificate:
 	{
-		Ty low = std::is_same_v<Ty, float> ? -18.021828 : -38.123094930796995;
-		Ty high = -1;
+		typename Evaluator::Certificate certificate;
+		for (Ty x : { (Ty)0, (Ty)INFINITY, (Ty)-1 })
+		{
+			eval(x, certificate);
+			if (!certificate.isSpecial || !evaluator.Verify(certificate))
+				ERROR(std::format("Failed special certificate x: {}", x));
+		}
 
-		std::uniform_real_distribution<Ty> dist{ low, high };
-		if (RunTest<Ty>(branch, [&]() { return GetEmUp<Ty>() + exp(dist(gen)); }))
-			return 1;
+		// Every single field tampered with must be rejected
+		for (Ty x : points)
+		{
+			eval(x, certificate);
+			std::vector<typename Evaluator::Certificate> tampered(7, certificate);
+			tampered[0].lowSign = certificate.highSign;
+			tampered[1].highSign = certificate.lowSign;
+			tampered[2].lowPrec = 17;
+			tampered[3].branch = -1 - certificate.branch;
+			tampered[4].isSpecial = true;
+			tampered[5].x = certificate.x * 2;
+			std::swap(tampered[6].low, tampered[6].high);
+			for (const auto& t : tampered)
+				if (evaluator.Verify(t))
+					ERROR(std::format("Tampered certificate accepted x: {}", x));
+		}
+
+		// A special certificate moved to a regular input
+		eval(0, certificate);
+		certificate.x = (Ty)-0.3;
+		if (evaluator.Verify(certificate))
+			ERROR("Tampered special certificate accepted");
+		return 0;
 	}
 
-	// Zero test
-	if (branch == 0)
-	{
-		std::conditional_t<std::is_same_v<Ty, float>, ReferenceWf, ReferenceW> evaluator;
-		auto [inf, sup] = evaluator.W0(0);
-		if (inf != 0 || sup != 0)
+	case Feature::Derivative:
+		if (branch == 0)
 		{
-			std::cerr << "Failed zero test!\n";
-			return 1;
+			auto [zeroInf, zeroSup] = evaluator.W0WithDerivative(0).derivative;
+			auto [infInf, infSup] = evaluator.W0WithDerivative(INFINITY).derivative;
+			if (zeroInf != 1 || zeroSup != 1 || infInf != 0 || infSup != 0)
+				ERROR("Failed derivative edge cases");
+		}
+
+		// Near -1/e, where W' grows without bound and has the branch's sign
+		Ty x = GetEmUp<Ty>();
+		for (size_t i = 0; i < 4; i++, x = std::nextafter(x, (Ty)0))
+		{
+			auto [w, derivative] = (branch == 0) ? evaluator.W0WithDerivative(x) : evaluator.Wm1WithDerivative(x);
+			thread_local Oracle<Ty> oracle;
+			bool isContained = oracle.EnclosesDerivative(x, w.inf, w.sup, derivative.inf, derivative.sup);
+			bool isLarge = (branch == 0) ? derivative.inf > 100 : derivative.sup < -100;
+			if (TestPoint(x, w) || !isContained || !isLarge)
+				ERROR(std::format("Failed derivative near the branch point x: {}", x));
 		}
+		return 0;
 	}
 
-	return 0;
+	return 1;
 }
 
+// The feature from --feature on the randomized points, with the search method from --engine
 template <typename Ty>
-int ExhaustiveTest(int64_t branch)
+int FeatureTest(int64_t branch, const SweepOptions& options, const RandomOptions& random)
 {
-	std::conditional_t<std::is_same_v<Ty, float>, ReferenceWf, ReferenceW> evaluator;
+	int ret = RunRandomized<Ty>(branch, options, random, [branch]()
+	{
+		return [branch, evaluator = BasicReferenceW<Ty>{ GetSearchMethod(engineName) }](Ty x) mutable
+		{
+			return TestFeature(evaluator, branch, x);
+		};
+	});
+	if (ret)
+		return 1;
 
-	Ty start = GetEmUp<Ty>();
-	Ty end = (branch == 0) ? INFINITY : 0;
+	if (random.shard == 0 && random.index < 0)
+		return TestFeatureEdgeCases<Ty>(branch);
+	return 0;
+}
 
-	Ty x = start;
-	for (size_t i = 0; x < end; i++, x = std::nextafter(x, INFINITY))
+// Consecutive doubles on both sides of every point where ReferenceW switches algorithm
+int ThresholdTest(int64_t branch, const SweepOptions& options)
+{
+	// === Parameters ===
+	static constexpr int64_t Radius = 1 << 20; // Doubles tested on each side of a threshold
+	// ==================
+
+	static constexpr double W0Thresholds[] = {
+		GetEmUp<double>(),	// -1/e
+		-0.28,				// Near branch series
+		-0.01,				// Derivative bound forms
+		-1e-4,				// First rational returns x
+		0,
+		1e-4,
+		0.01,
+		1,					// Residual bound scaling
+		4.11380962917,		// Arb residual bound
+		7.34				// First vs. second rational
+	};
+
+	static constexpr double Wm1Thresholds[] = {
+		GetEmUp<double>(),	// -1/e
+		-0.318092372804,	// Near branch series
+		-0.00000137095397731, // Arb residual bound
+		-1e-300,			// Scaled Fritsch iteration
+		0
+	};
+
+	// Domain of the branch as ordered integers, [domainLow, domainHigh)
+	int64_t domainLow = ToOrdered(GetEmUp<double>());
+	int64_t domainHigh = ToOrdered<double>((branch == 0) ? INFINITY : 0);
+
+	// Ranges of ordered integers, clipped to the domain
+	std::vector<std::pair<int64_t, uint64_t>> ranges;
+	std::vector<uint64_t> offsets{ 0 };
+	auto addRange = [&](double threshold)
 	{
-		decltype(evaluator.W0(Ty{})) res;
-		if (branch == 0)
-			res = evaluator.W0(x);
-		else
-			res = evaluator.Wm1(x);
+		int64_t low = std::max(ToOrdered(threshold) - Radius, domainLow);
+		int64_t high = std::min(ToOrdered(threshold) + Radius, domainHigh);
+		ranges.emplace_back(low, (uint64_t)(high - low));
+		offsets.push_back(offsets.back() + (uint64_t)(high - low));
+	};
 
-		if (TestPoint(x, res)) return 1;
-	}
+	if (branch == 0)
+		for (double threshold : W0Thresholds) addRange(threshold);
+	else
+		for (double threshold : Wm1Thresholds) addRange(threshold);
+
+	return RunSweep(offsets.back(), options, [&]()
+	{
+		return [&ranges, &offsets, branch, evaluator = MakeEngine<double>(engineName)](uint64_t i) mutable
+		{
+			size_t r = std::upper_bound(offsets.begin(), offsets.end(), i) - offsets.begin() - 1;
+			double x = FromOrdered<double>(ranges[r].first + (int64_t)(i - offsets[r]));
 
+			Interval res;
+			if (branch == 0)
+				res = evaluator->W0(x);
+			else
+				res = evaluator->Wm1(x);
+
+			return TestPoint(x, res);
+		};
+	});
+}
+
+// Once the arena allocator is populated, evaluation must never reach the system allocator
+int AllocationTest(const RandomOptions& random)
+{
+	// === Parameters ===
+	static constexpr uint64_t Points = 20'000; // Per distribution, per pass
+	// ==================
+
+	// Before anything allocates through FLINT or GMP
+	InstallArenaAllocator();
+	ReferenceW::Warmup();
+	ReferenceWf::Warmup();
+
+	ReferenceW evaluator;
+	ReferenceWf evaluatorf;
+	auto pass = [&](uint64_t seed)
+	{
+		for (int64_t branch : { 0, -1 })
+		{
+			PointSampler<double> sampler{ branch, seed, Points };
+			for (uint64_t i = 0; i < sampler.Size(); i++)
+				(branch == 0) ? evaluator.W0(sampler(i)) : evaluator.Wm1(sampler(i));
+
+			PointSampler<float> samplerf{ branch, seed, Points };
+			for (uint64_t i = 0; i < samplerf.Size(); i++)
+				(branch == 0) ? evaluatorf.W0(samplerf(i)) : evaluatorf.Wm1(samplerf(i));
+		}
+	};
+
+	// The first pass fills the size classes evaluation uses, the second is steady state
+	pass(random.seed);
+	size_t before = GetSystemAllocations();
+	pass(random.seed + 1);
+	size_t allocations = GetSystemAllocations() - before;
+
+	if (allocations != 0)
+		ERROR(std::format("{} system allocations in steady state", allocations));
 	return 0;
 }
 
 int main(int argc, char** argv)
 {
+	// tests <idx> [--threads k] [--checkpoint file] [--resume] [--keep-going] [--stop-after n]
+	//		[--seed s] [--points n] [--shard i/n] [--index i] [--engine reference|illinois|newton|arb|mpfr]
+	//		[--feature widths|budget|certificate|derivative]
+
 	// Check number of arguments is correct
-	if (argc != 2)
-		ERROR("Test must have exactly one extra argument");
+	if (argc < 2)
+		ERROR("Test must have at least one extra argument");
 
 	// Get second argument
 	std::string arg{ argv[1] };
@@ -210,14 +584,111 @@ int main(int argc, char** argv)
 	if (convRes.ec != std::errc())
 		ERROR("Test index could not be parsed");
 
+	// Options
+	SweepOptions options;
+	RandomOptions random;
+	bool hasSeed = false;
+	for (int i = 2; i < argc; i++)
+	{
+		std::string option{ argv[i] };
+		std::string value = (i + 1 < argc) ? argv[i + 1] : "";
+		auto parse = [&](auto& out) { i++; return std::from_chars(value.data(), value.data() + value.size(), out).ec == std::errc(); };
+
+		if (option == "--threads")
+		{
+			if (!parse(options.threads) || options.threads == 0)
+				ERROR("Thread count could not be parsed");
+		}
+		else if (option == "--checkpoint" && i + 1 < argc)
+			options.checkpointPath = argv[++i];
+		else if (option == "--resume")
+			options.resume = true;
+		else if (option == "--keep-going")
+			options.keepGoing = true;
+		else if (option == "--stop-after")
+		{
+			if (!parse(options.stopAfter))
+				ERROR("Stop point could not be parsed");
+		}
+		else if (option == "--seed")
+		{
+			if (!parse(random.seed))
+				ERROR("Seed could not be parsed");
+			hasSeed = true;
+		}
+		else if (option == "--points")
+		{
+			if (!parse(random.points) || random.points == 0)
+				ERROR("Point count could not be parsed");
+		}
+		else if (option == "--index")
+		{
+			if (!parse(random.index) || random.index < 0)
+				ERROR("Index could not be parsed");
+		}
+		else if (option == "--shard")
+		{
+			i++;
+			size_t slash = value.find('/');
+			if (slash == std::string::npos)
+				ERROR("Shard must be of the form i/n");
+			auto first = std::from_chars(value.data(), value.data() + slash, random.shard);
+			auto second = std::from_chars(value.data() + slash + 1, value.data() + value.size(), random.numShards);
+			if (first.ec != std::errc() || second.ec != std::errc() || random.shard >= random.numShards)
+				ERROR("Shard must be of the form i/n");
+		}
+		else if (option == "--engine" && i + 1 < argc)
+		{
+			engineName = argv[++i];
+			if (std::ranges::find(EngineNames, engineName) == std::ranges::end(EngineNames))
+				ERROR(std::format("Unknown engine: {}", engineName));
+		}
+		else if (option == "--feature" && i + 1 < argc)
+		{
+			auto it = std::ranges::find(FeatureNames, std::string_view{ argv[++i] });
+			if (it == std::ranges::end(FeatureNames))
+				ERROR(std::format("Unknown feature: {}", argv[i]));
+			feature = (Feature)(it - std::ranges::begin(FeatureNames));
+		}
+		else
+			ERROR(std::format("Unknown option: {}", option));
+	}
+
+	// Only randomized tests depend on the seed, points and shard, the others must resume without them
+	bool isRandomized = testIdx <= 3 || testIdx == 6 || testIdx == 7 || (testIdx >= 11 && testIdx <= 14);
+	bool usesSeed = isRandomized || testIdx == 10;
+
+	// Print the seed so failures can be replayed
+	if (usesSeed && !hasSeed)
+	{
+		random.seed = std::random_device{}() | ((uint64_t)std::random_device{}() << 32);
+		std::cout << std::format("Seed: {}\n", random.seed);
+	}
+
+	if (isRandomized)
+		options.sweepId = std::format("{}:{}:{}:{}/{}:{}:{}", arg, random.seed, random.points, random.shard, random.numShards, engineName, FeatureNames[(int)feature]);
+	else
+		options.sweepId = std::format("{}:{}", arg, engineName);
+	if (options.resume && options.checkpointPath.empty())
+		options.checkpointPath = std::format("tests{}.checkpoint", arg);
+
 	switch (testIdx)
 	{
-	case 0: return RunTest<float>(0);
-	case 1: return RunTest<float>(-1);
-	case 2: return RunTest<double>(0);
-	case 3: return RunTest<double>(-1);
-	case 4: return ExhaustiveTest<float>(0);
-	case 5: return ExhaustiveTest<float>(-1);
+	case 0: return RunTest<float>(0, options, random);
+	case 1: return RunTest<float>(-1, options, random);
+	case 2: return RunTest<double>(0, options, random);
+	case 3: return RunTest<double>(-1, options, random);
+	case 4: return ExhaustiveTest<float>(0, options);
+	case 5: return ExhaustiveTest<float>(-1, options);
+	case 6: return RunDerivedTest(0, options, random);
+	case 7: return RunDerivedTest(-1, options, random);
+	case 8: return ThresholdTest(0, options);
+	case 9: return ThresholdTest(-1, options);
+	case 10: return AllocationTest(random);
+	case 11: return FeatureTest<float>(0, options, random);
+	case 12: return FeatureTest<float>(-1, options, random);
+	case 13: return FeatureTest<double>(0, options, random);
+	case 14: return FeatureTest<double>(-1, options, random);
 	default: ERROR("Invalid test index");
 	}
 }
\ No newline at end of file